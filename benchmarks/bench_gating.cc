@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+#include <disruptor/disruptor.h>
+
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+static constexpr int64_t kRingSize = 1024;
+static constexpr int64_t kEventsPerIteration = 100 * 1000;
+
+/**
+ *  The scan behind a producer's wrap check when it misses the cached
+ *  minimum, state.range(0) is the number of consumers gating it.
+ */
+void BM_gating_get_min(benchmark::State& state) {
+  disruptor::Barrier barrier;
+  std::vector<std::shared_ptr<disruptor::Sequence>> consumers;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    consumers.push_back(std::make_shared<disruptor::Sequence>());
+    consumers.back()->store(i);
+    barrier.follow(consumers.back());
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        barrier.get_min(std::numeric_limits<int64_t>::max()));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ *  Producer throughput in a 1 to state.range(0) fan out, every consumer
+ *  on a thread of its own.
+ */
+void BM_fan_out(benchmark::State& state) {
+  const auto consumer_num = state.range(0);
+  int64_t events = 0;
+
+  for (auto _ : state) {
+    auto ring = std::make_shared<disruptor::RingBuffer<int64_t, kRingSize>>();
+    auto producer =
+        std::make_shared<disruptor::SingleProducerSequencer>(kRingSize);
+    std::vector<std::shared_ptr<
+        disruptor::BasicConsumerSequencer<disruptor::YieldingWaitStrategy>>>
+        consumers;
+    for (int64_t i = 0; i < consumer_num; ++i) {
+      consumers.push_back(std::make_shared<disruptor::BasicConsumerSequencer<
+                              disruptor::YieldingWaitStrategy>>());
+      consumers.back()->follow(producer);
+      producer->follow(consumers.back());
+    }
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (auto& consumer : consumers) {
+      threads.emplace_back([&, consumer] {
+        auto next_sequence = consumer->acquire() + 1;
+        while (next_sequence < kEventsPerIteration) {
+          auto available_sequence = consumer->wait_for(next_sequence);
+          for (; next_sequence <= available_sequence; ++next_sequence) {
+            benchmark::DoNotOptimize(ring->at(next_sequence));
+          }
+          consumer->publish(available_sequence);
+        }
+      });
+    }
+
+    for (int64_t i = 0; i < kEventsPerIteration; ++i) {
+      auto pos = producer->next();
+      ring->at(pos) = pos;
+      producer->publish(pos);
+    }
+    for (auto& t : threads) t.join();
+    state.SetIterationTime(std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count());
+    events += kEventsPerIteration;
+  }
+  state.SetItemsProcessed(events);
+}
+
+BENCHMARK(BM_gating_get_min)->ArgName("consumers")->RangeMultiplier(2)->Range(
+    1, 64);
+BENCHMARK(BM_fan_out)
+    ->ArgName("consumers")
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,105 @@
+#include <benchmark/benchmark.h>
+#include <disruptor/disruptor.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+static constexpr int64_t kRingSize = 1024;
+static constexpr int64_t kEventsPerProducer = 100 * 1000;
+
+void translate(int64_t& event, int64_t, int64_t value) { event = value; }
+
+/**
+ *  state.range(0) producers publishing into one MultiProducerSequencer,
+ *  all claiming on the same cursor.
+ */
+void BM_producers_one_ring(benchmark::State& state) {
+  const auto producer_num = state.range(0);
+  int64_t events = 0;
+  for (auto _ : state) {
+    auto ring = std::make_shared<disruptor::RingBuffer<int64_t, kRingSize>>();
+    auto producer =
+        std::make_shared<disruptor::MultiProducerSequencer>(kRingSize);
+    auto consumer = std::make_shared<disruptor::ConsumerSequencer>();
+    consumer->follow(producer);
+    producer->follow(consumer);
+
+    const auto total = kEventsPerProducer * producer_num;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int64_t p = 0; p < producer_num; ++p) {
+      threads.emplace_back([&] {
+        for (int64_t i = 0; i < kEventsPerProducer; ++i)
+          disruptor::publish_event(*ring, *producer, translate, i);
+      });
+    }
+    int64_t next_sequence = 0;
+    while (next_sequence < total) {
+      auto available_sequence = consumer->wait_for(next_sequence);
+      for (; next_sequence <= available_sequence; ++next_sequence) {
+        benchmark::DoNotOptimize(ring->at(next_sequence));
+      }
+      consumer->publish(available_sequence);
+    }
+    for (auto& t : threads) t.join();
+    state.SetIterationTime(std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count());
+    events += total;
+  }
+  state.SetItemsProcessed(events);
+}
+
+/** the same producers, each on a shard of its own */
+void BM_producers_sharded(benchmark::State& state) {
+  const auto producer_num = state.range(0);
+  int64_t events = 0;
+  for (auto _ : state) {
+    disruptor::ShardedRing<int64_t> ring(static_cast<size_t>(producer_num),
+                                         kRingSize);
+
+    const auto total = kEventsPerProducer * producer_num;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int64_t p = 0; p < producer_num; ++p) {
+      threads.emplace_back([&] {
+        auto shard = ring.claim_shard();
+        for (int64_t i = 0; i < kEventsPerProducer; ++i)
+          ring.publish_event(shard, translate, i);
+      });
+    }
+    int64_t consumed = 0;
+    while (consumed < total) {
+      auto processed = ring.poll([](const int64_t& event, size_t, int64_t) {
+        benchmark::DoNotOptimize(event);
+      });
+      if (processed == 0) std::this_thread::yield();
+      consumed += processed;
+    }
+    for (auto& t : threads) t.join();
+    state.SetIterationTime(std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count());
+    events += total;
+  }
+  state.SetItemsProcessed(events);
+}
+
+BENCHMARK(BM_producers_one_ring)
+    ->ArgName("producers")
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_producers_sharded)
+    ->ArgName("producers")
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
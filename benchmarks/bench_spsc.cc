@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+#include <disruptor/disruptor.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace {
+
+static constexpr int64_t kRingSize = 1024;
+static constexpr int64_t kEventsPerIteration = 1000 * 1000;
+
+/**
+ *  One producer and one consumer through SpscChannel, one event per
+ *  next() and publish().
+ */
+void BM_spsc_channel(benchmark::State& state) {
+  int64_t events = 0;
+  for (auto _ : state) {
+    auto channel = std::make_shared<disruptor::SpscChannel<
+        int64_t, kRingSize, disruptor::YieldingWaitStrategy>>();
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer{[&] {
+      int64_t next_sequence = 0;
+      while (next_sequence < kEventsPerIteration) {
+        auto available_sequence = channel->wait_for(next_sequence);
+        for (; next_sequence <= available_sequence; ++next_sequence) {
+          benchmark::DoNotOptimize(channel->at(next_sequence));
+        }
+        channel->release(available_sequence);
+      }
+    }};
+    for (int64_t i = 0; i < kEventsPerIteration; ++i) {
+      auto pos = channel->next();
+      channel->at(pos) = pos;
+      channel->publish(pos);
+    }
+    consumer.join();
+    state.SetIterationTime(std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count());
+    events += kEventsPerIteration;
+  }
+  state.SetItemsProcessed(events);
+}
+
+/** the same through the general sequencers, for comparison */
+void BM_spsc_sequencers(benchmark::State& state) {
+  int64_t events = 0;
+  for (auto _ : state) {
+    auto ring = std::make_shared<disruptor::RingBuffer<int64_t, kRingSize>>();
+    auto producer =
+        std::make_shared<disruptor::SingleProducerSequencer>(kRingSize);
+    auto consumer_sequence = std::make_shared<
+        disruptor::BasicConsumerSequencer<disruptor::YieldingWaitStrategy>>();
+    consumer_sequence->follow(producer);
+    producer->follow(consumer_sequence);
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer{[&] {
+      int64_t next_sequence = 0;
+      while (next_sequence < kEventsPerIteration) {
+        auto available_sequence = consumer_sequence->wait_for(next_sequence);
+        for (; next_sequence <= available_sequence; ++next_sequence) {
+          benchmark::DoNotOptimize(ring->at(next_sequence));
+        }
+        consumer_sequence->publish(available_sequence);
+      }
+    }};
+    for (int64_t i = 0; i < kEventsPerIteration; ++i) {
+      auto pos = producer->next();
+      ring->at(pos) = pos;
+      producer->publish(pos);
+    }
+    consumer.join();
+    state.SetIterationTime(std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count());
+    events += kEventsPerIteration;
+  }
+  state.SetItemsProcessed(events);
+}
+
+BENCHMARK(BM_spsc_channel)->UseManualTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_spsc_sequencers)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,185 @@
+#include <benchmark/benchmark.h>
+#include <disruptor/disruptor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "latency_histogram.h"
+
+namespace {
+
+static constexpr int kThreadNum = 3;
+static constexpr int64_t kEventsPerIteration = 200 * 1000;
+
+enum class Shape {
+  kOneProducerOneConsumer,
+  kOneProducerMultiConsumer,
+  kMultiProducerOneConsumer,
+  kMultiProducerMultiConsumer,
+  kPipeline,  // p -> a -> b -> c
+  kDiamond,   // p -> (a || b) -> c
+};
+
+template <size_t Size>
+struct Event {
+  static_assert(Size >= 16, "events carry a timestamp and a position");
+  uint64_t stamp;
+  int64_t pos;
+  char payload[Size - 16];
+};
+
+void publish(disruptor::SingleProducerSequencer& producer, int64_t end,
+             int64_t) {
+  producer.publish(end);
+}
+
+void publish(disruptor::MultiProducerSequencer& producer, int64_t end,
+             int64_t batch) {
+  producer.publish_after(end, end - batch);
+}
+
+/**
+ *  Pushes kEventsPerIteration events through the shape once.
+ *
+ *  @return the wall time it took, the end-to-end latency of every event
+ *  seen by a terminal consumer goes into histogram
+ */
+template <typename Sequencer, typename EventType>
+double run_once(Shape shape, int producer_num, int64_t ring_size,
+                int64_t batch, bench::LatencyHistogram& histogram) {
+  const int64_t per_producer =
+      kEventsPerIteration / producer_num / batch * batch;
+  const int64_t total = per_producer * producer_num;
+
+  auto ring = std::make_shared<disruptor::DynamicRingBuffer<EventType>>(
+      ring_size);
+  auto producer = std::make_shared<Sequencer>(ring_size);
+
+  std::vector<std::shared_ptr<disruptor::ConsumerSequencer>> consumers;
+  auto consumer_num = shape == Shape::kOneProducerOneConsumer ||
+                              shape == Shape::kMultiProducerOneConsumer
+                          ? 1
+                          : kThreadNum;
+  for (int i = 0; i < consumer_num; ++i) {
+    consumers.push_back(std::make_shared<disruptor::ConsumerSequencer>());
+  }
+
+  disruptor::Topology topology(producer);
+  switch (shape) {
+    case Shape::kPipeline:
+      for (auto& consumer : consumers) topology.then(consumer);
+      break;
+    case Shape::kDiamond:
+      topology.and_then_parallel(consumers[0], consumers[1])
+          .join(consumers[2]);
+      break;
+    default:
+      topology.and_then_parallel(consumers);
+      break;
+  }
+  topology.build();
+  const auto& terminals = topology.gating_sequences();
+
+  std::vector<bench::LatencyHistogram> histograms(consumers.size());
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < consumers.size(); ++i) {
+    auto terminal = std::find(terminals.begin(), terminals.end(),
+                              consumers[i]) != terminals.end();
+    threads.emplace_back([&, i, terminal] {
+      auto& consumer = consumers[i];
+      auto next_sequence = consumer->acquire() + 1;
+      while (next_sequence < total) {
+        auto available_sequence = consumer->wait_for(next_sequence);
+        auto now = bench::timestamp();
+        for (; next_sequence <= available_sequence; ++next_sequence) {
+          const auto& event = ring->at(next_sequence);
+          benchmark::DoNotOptimize(event.pos);
+          if (terminal) histograms[i].record(now - event.stamp);
+        }
+        consumer->publish(available_sequence);
+      }
+    });
+  }
+
+  for (int p = 0; p < producer_num; ++p) {
+    threads.emplace_back([&] {
+      for (int64_t n = 0; n < per_producer; n += batch) {
+        auto end = producer->next(batch);
+        auto stamp = bench::timestamp();
+        for (auto pos = end - batch + 1; pos <= end; ++pos) {
+          auto& event = ring->at(pos);
+          event.stamp = stamp;
+          event.pos = pos;
+        }
+        publish(*producer, end, batch);
+      }
+    });
+  }
+
+  for (auto& t : threads) t.join();
+  auto elapsed = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  for (auto& h : histograms) histogram.merge(h);
+  return elapsed;
+}
+
+/**
+ *  state.range(0) is the ring size, state.range(1) the producer batch size.
+ */
+template <Shape shape, size_t EventSize>
+void BM_topology(benchmark::State& state) {
+  using EventType = Event<EventSize>;
+  const auto ring_size = state.range(0);
+  const auto batch = state.range(1);
+  const auto multi_producer = shape == Shape::kMultiProducerOneConsumer ||
+                              shape == Shape::kMultiProducerMultiConsumer;
+
+  bench::LatencyHistogram histogram;
+  int64_t events = 0;
+  for (auto _ : state) {
+    auto elapsed =
+        multi_producer
+            ? run_once<disruptor::MultiProducerSequencer, EventType>(
+                  shape, kThreadNum, ring_size, batch, histogram)
+            : run_once<disruptor::SingleProducerSequencer, EventType>(
+                  shape, 1, ring_size, batch, histogram);
+    state.SetIterationTime(elapsed);
+    events += kEventsPerIteration / batch * batch;
+  }
+
+  auto ns_per_tick = bench::ns_per_tick();
+  state.SetItemsProcessed(events);
+  state.SetBytesProcessed(events * static_cast<int64_t>(EventSize));
+  state.counters["p50_ns"] = histogram.percentile(0.5) * ns_per_tick;
+  state.counters["p99_ns"] = histogram.percentile(0.99) * ns_per_tick;
+  state.counters["p99.9_ns"] = histogram.percentile(0.999) * ns_per_tick;
+  state.counters["max_ns"] = histogram.max() * ns_per_tick;
+}
+
+void topology_args(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"ring", "batch"});
+  for (int64_t ring_size : {1 << 10, 1 << 16}) {
+    for (int64_t batch : {1, 16}) b->Args({ring_size, batch});
+  }
+  b->UseManualTime()->Unit(benchmark::kMillisecond);
+}
+
+#define DISRUPTOR_TOPOLOGY_BENCHMARK(shape)                          \
+  BENCHMARK_TEMPLATE(BM_topology, Shape::shape, 16)->Apply(topology_args); \
+  BENCHMARK_TEMPLATE(BM_topology, Shape::shape, 256)->Apply(topology_args)
+
+DISRUPTOR_TOPOLOGY_BENCHMARK(kOneProducerOneConsumer);
+DISRUPTOR_TOPOLOGY_BENCHMARK(kOneProducerMultiConsumer);
+DISRUPTOR_TOPOLOGY_BENCHMARK(kMultiProducerOneConsumer);
+DISRUPTOR_TOPOLOGY_BENCHMARK(kMultiProducerMultiConsumer);
+DISRUPTOR_TOPOLOGY_BENCHMARK(kPipeline);
+DISRUPTOR_TOPOLOGY_BENCHMARK(kDiamond);
+
+}  // namespace
@@ -0,0 +1,106 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench {
+
+/** a cheap timestamp taken inside every event, in ticks */
+inline uint64_t timestamp() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+/** @return how many nanoseconds one timestamp() tick takes */
+inline double ns_per_tick() {
+  static const double ns_per_tick = [] {
+#if defined(__x86_64__) || defined(__i386__)
+    auto start = std::chrono::steady_clock::now();
+    auto start_ticks = timestamp();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto ticks = timestamp() - start_ticks;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    return (double)ns / (double)ticks;
+#else
+    return 1.0;
+#endif
+  }();
+  return ns_per_tick;
+}
+
+/**
+ *  HDR style histogram: values are bucketed by their highest set bit and
+ *  then linearly by the next kSubBucketBits bits, so every bucket is within
+ *  1 / 2^kSubBucketBits of the values it holds, from a tick to years.
+ */
+class LatencyHistogram {
+ public:
+  void record(uint64_t value) {
+    ++counts_[bucket(value)];
+    ++total_;
+    max_ = std::max(max_, value);
+  }
+
+  void merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+    total_ += other.total_;
+    max_ = std::max(max_, other.max_);
+  }
+
+  /** @return the value at or below which a fraction p of samples lie */
+  uint64_t percentile(double p) const {
+    if (total_ == 0) return 0;
+    auto rank = static_cast<uint64_t>(p * (double)(total_ - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      seen += counts_[i];
+      if (seen >= rank) return std::min(upper_bound(i), max_);
+    }
+    return max_;
+  }
+
+  uint64_t max() const { return max_; }
+  uint64_t count() const { return total_; }
+
+ private:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr uint64_t kSubBuckets = 1 << kSubBucketBits;
+
+  static size_t bucket(uint64_t value) {
+    if (value < kSubBuckets) return static_cast<size_t>(value);
+    int shift = 63 - __builtin_clzll(value) - kSubBucketBits;
+    return static_cast<size_t>((shift + 1) * kSubBuckets +
+                               ((value >> shift) - kSubBuckets));
+  }
+
+  static uint64_t upper_bound(size_t index) {
+    if (index < kSubBuckets) return index;
+    auto shift = index / kSubBuckets - 1;
+    auto sub_bucket = index % kSubBuckets + kSubBuckets;
+    return ((sub_bucket + 1) << shift) - 1;
+  }
+
+  std::array<uint64_t, (64 - kSubBucketBits + 1) * kSubBuckets> counts_{};
+  uint64_t total_ = 0;
+  uint64_t max_ = 0;
+};
+
+}  // namespace bench
@@ -0,0 +1,104 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#include <disruptor/exceptions.h>
+#include <disruptor/placement.h>
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+namespace disruptor {
+
+/**
+ *  Tracks which slots of a ring buffer have been published when several
+ *  producers claim and publish out of order.
+ *
+ *  Every slot remembers the last sequence published into it.  Sequences
+ *  claimed for the same slot are exactly size() apart, so pos has been
+ *  published once its slot holds a value >= pos, while a slot still holding
+ *  pos - size() is waiting for the producer that claimed pos.
+ */
+class AvailabilityBuffer {
+ public:
+  /** @param size - the size of the ringbuffer, must be a power of 2 */
+  explicit AvailabilityBuffer(int64_t size)
+      : mask_(to_mask(size)),
+        published_(new std::atomic<int64_t>[size], Unmap()) {
+    for (int64_t i = 0; i < size; ++i) {
+      published_[i].store(i - size, std::memory_order_relaxed);
+    }
+  }
+
+  /** marks every position in [begin, end] as published */
+  void set_available(int64_t begin, int64_t end) {
+    for (auto pos = begin; pos <= end; ++pos) {
+      published_[pos & mask_].store(pos, std::memory_order_release);
+    }
+  }
+
+  bool is_available(int64_t pos) const {
+    return published_[pos & mask_].load(std::memory_order_acquire) >= pos;
+  }
+
+  /**
+   *  Claimed positions below begin must already be published.
+   *
+   *  @return the highest position in [begin - 1, end] such that every
+   *  position from begin up to it has been published.
+   */
+  int64_t highest_published(int64_t begin, int64_t end) const {
+    for (auto pos = begin; pos <= end; ++pos) {
+      if (!is_available(pos)) return pos - 1;
+    }
+    return end;
+  }
+
+  int64_t size() const { return mask_ + 1; }
+
+  /**
+   *  Moves the words to pages of their own bound to node, every publish
+   *  writes them.  Not thread safe, call it before the buffer is used.
+   */
+  void bind_to_numa_node(int node) {
+    auto bytes = detail::page_round_up(size() * sizeof(std::atomic<int64_t>));
+    auto words = static_cast<std::atomic<int64_t>*>(
+        detail::map_on_numa_node(bytes, node));
+    for (int64_t i = 0; i < size(); ++i) {
+      new (&words[i]) std::atomic<int64_t>(
+          published_[i].load(std::memory_order_relaxed));
+    }
+    published_ = Words(words, Unmap{bytes});
+  }
+
+ private:
+  /** frees the words, allocated with new[] unless mapped */
+  struct Unmap {
+    size_t bytes = 0;
+    void operator()(std::atomic<int64_t>* words) const {
+      if (bytes == 0) {
+        delete[] words;
+      } else {
+        munmap(words, bytes);
+      }
+    }
+  };
+  typedef std::unique_ptr<std::atomic<int64_t>[], Unmap> Words;
+
+  static int64_t to_mask(int64_t size) {
+    if (size < 1 || (size & (size - 1)) != 0)
+      detail::throw_exception<std::runtime_error>("size must be a power of 2");
+    return size - 1;
+  }
+
+  const int64_t mask_;
+  Words published_;
+};
+
+}  // namespace disruptor
@@ -0,0 +1,316 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+// C++20 only, empty otherwise
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <disruptor/eof.h>
+#include <disruptor/eventfd_notifier.h>
+#include <disruptor/exceptions.h>
+#include <disruptor/membarrier.h>
+#include <disruptor/sequence.h>
+#include <poll.h>
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace disruptor {
+
+class CoroutineScheduler;
+
+namespace detail {
+
+/** a coroutine suspended on a ring, lives in the coroutine frame */
+class RingAwaiter {
+ public:
+  explicit RingAwaiter(CoroutineScheduler& scheduler)
+      : scheduler_(scheduler) {}
+  virtual ~RingAwaiter() = default;
+
+  /** polls the ring once, keeping the result for await_resume()
+   *  @return whether the coroutine can go on */
+  virtual bool ready() = 0;
+
+ protected:
+  void suspend(std::coroutine_handle<> handle);
+
+ private:
+  friend class disruptor::CoroutineScheduler;
+
+  CoroutineScheduler& scheduler_;
+  std::coroutine_handle<> handle_;
+  RingAwaiter* next_ = nullptr;
+};
+
+}  // namespace detail
+
+/**
+ *  Resumes coroutines suspended on rings, so that a single thread can
+ *  serve many rings instead of blocking one thread in every consumer.
+ *
+ *  A coroutine awaits a batch with AsyncConsumer or a claim with
+ *  AsyncProducer.  When the ring is ready already it goes on without
+ *  suspending.  Otherwise it is put on the scheduler's list, and the
+ *  thread owning the scheduler polls the rings of that list in run_once()
+ *  and resumes the coroutines that can go on.  With nothing ready that
+ *  thread parks on an EventFdNotifier, which the cursors attached wake.
+ *
+ *  The notifier is only attached to the cursors while the scheduler is
+ *  parked, a detail::process_fence() after attaching makes sure no
+ *  publish is missed.  Publishing on a cursor costs nothing extra unless
+ *  the scheduler is asleep.  Where that fence is not available the cursors
+ *  stay attached, and every publish on them pays for a fence.
+ *
+ *  @code
+ *  CoroutineScheduler scheduler;
+ *  scheduler.attach(*producer);  // what the consumers wait for
+ *  AsyncConsumer<ConsumerSequencer> consumer(scheduler, consumer_sequence);
+ *
+ *  Task consume() {  // any coroutine type
+ *    int64_t next_sequence = 0;
+ *    while (true) {
+ *      auto available = co_await consumer.next_batch(next_sequence);
+ *      if (available < next_sequence) break;  // kEof, kHalted or kOverrun
+ *      for (; next_sequence <= available; ++next_sequence) { ... }
+ *      consumer_sequence->publish(available);
+ *    }
+ *  }
+ *
+ *  // the worker thread
+ *  scheduler.run();
+ *  @endcode
+ *
+ *  Coroutines must await on the thread owning the scheduler, and may not
+ *  be destroyed while suspended.  fd() becomes readable once a parked
+ *  scheduler has something to resume, to run the scheduler from an epoll
+ *  loop instead, see EventFdNotifier.
+ */
+class CoroutineScheduler {
+ public:
+  CoroutineScheduler()
+      : attach_while_parked_(detail::process_fence_available()) {}
+  CoroutineScheduler(const CoroutineScheduler&) = delete;
+  CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+  /**
+   *  Has publishing on s wake the parked scheduler: attach the producer
+   *  cursors awaited by consumers and the consumer cursors gating the
+   *  producers that await claims.  s must outlive the scheduler or be
+   *  detached first, and may not be process shared.
+   */
+  void attach(const Sequence& s) {
+    if (s.process_shared())
+      detail::throw_exception<std::logic_error>(
+          "a process shared sequence can not wake a scheduler");
+    if (!attach_while_parked_) notifier_.attach(s);
+    sequences_.push_back(&s);
+  }
+
+  /** @return false if s was not attached */
+  bool detach(const Sequence& s) {
+    auto itr = std::find(sequences_.begin(), sequences_.end(), &s);
+    if (itr == sequences_.end()) return false;
+    if (!attach_while_parked_) notifier_.detach(s);
+    sequences_.erase(itr);
+    return true;
+  }
+
+  int fd() const { return notifier_.fd(); }
+
+  /** @return whether no coroutine is suspended */
+  bool empty() const { return head_ == nullptr; }
+
+  /**
+   *  Resumes the suspended coroutines that can go on, without waiting.
+   *
+   *  @return the number of coroutines resumed
+   */
+  size_t poll() {
+    // coroutines resumed may suspend again, they go on a fresh list
+    auto awaiter = head_;
+    head_ = nullptr;
+    tail_ = &head_;
+
+    size_t resumed = 0;
+    while (awaiter != nullptr) {
+      auto next = awaiter->next_;
+      if (awaiter->ready()) {
+        ++resumed;
+        awaiter->handle_.resume();
+      } else {
+        push(awaiter);
+      }
+      awaiter = next;
+    }
+    return resumed;
+  }
+
+  /**
+   *  Like poll(), but sleeps until a cursor attached is published to when
+   *  none of the suspended coroutines can go on.
+   *
+   *  @return the number of coroutines resumed, 0 if none is suspended
+   */
+  size_t run_once() {
+    auto resumed = poll();
+    if (resumed > 0 || empty()) return resumed;
+
+    // publishers that did not see the notifier attached published before
+    // its process fence, and the poll() below sees it
+    if (attach_while_parked_) notifier_.attach(sequences_);
+    notifier_.park();
+    // re-check, a cursor may have been published to before we parked
+    resumed = poll();
+    if (resumed == 0 && !empty()) {
+      struct pollfd p {};
+      p.fd = notifier_.fd();
+      p.events = POLLIN;
+      ::poll(&p, 1, -1);
+    }
+    notifier_.unpark();
+    if (attach_while_parked_) {
+      for (auto s : sequences_) notifier_.detach(*s);
+    }
+    return resumed + poll();
+  }
+
+  /** resumes coroutines until none is suspended any more */
+  void run() {
+    while (!empty()) run_once();
+  }
+
+ private:
+  friend class detail::RingAwaiter;
+
+  void push(detail::RingAwaiter* awaiter) {
+    awaiter->next_ = nullptr;
+    *tail_ = awaiter;
+    tail_ = &awaiter->next_;
+  }
+
+  const bool attach_while_parked_;
+  std::vector<const Sequence*> sequences_;
+  EventFdNotifier notifier_;
+  // resumed in the order they suspended
+  detail::RingAwaiter* head_ = nullptr;
+  detail::RingAwaiter** tail_ = &head_;
+};
+
+namespace detail {
+
+inline void RingAwaiter::suspend(std::coroutine_handle<> handle) {
+  handle_ = handle;
+  scheduler_.push(this);
+}
+
+}  // namespace detail
+
+/**
+ *  Awaits batches of a consumer cursor on a CoroutineScheduler, the
+ *  cursor is then published to as usual.
+ */
+template <typename Consumer>
+class AsyncConsumer {
+ public:
+  class BatchAwaiter : public detail::RingAwaiter {
+   public:
+    BatchAwaiter(CoroutineScheduler& scheduler, Consumer& consumer,
+                 int64_t next_sequence)
+        : RingAwaiter(scheduler),
+          consumer_(consumer),
+          next_sequence_(next_sequence) {}
+
+    bool ready() override {
+      available_ = consumer_.try_wait_for(next_sequence_);
+      // kEof, kHalted and kOverrun are all below INIT_SEQUENCE
+      return available_ >= next_sequence_ ||
+             available_ < Sequence::INIT_SEQUENCE;
+    }
+
+    bool await_ready() { return ready(); }
+    void await_suspend(std::coroutine_handle<> handle) { suspend(handle); }
+    int64_t await_resume() const { return available_; }
+
+   private:
+    Consumer& consumer_;
+    const int64_t next_sequence_;
+    int64_t available_ = Sequence::INIT_SEQUENCE;
+  };
+
+  AsyncConsumer(CoroutineScheduler& scheduler,
+                std::shared_ptr<Consumer> consumer)
+      : scheduler_(scheduler), consumer_(std::move(consumer)) {}
+
+  /**
+   *  co_await suspends until next_sequence is published.
+   *
+   *  @return the highest position available, or kEof / kHalted / kOverrun,
+   *  see Consumer::wait_for()
+   */
+  BatchAwaiter next_batch(int64_t next_sequence) {
+    return BatchAwaiter(scheduler_, *consumer_, next_sequence);
+  }
+
+ private:
+  CoroutineScheduler& scheduler_;
+  std::shared_ptr<Consumer> consumer_;
+};
+
+/**
+ *  Awaits claims of a producer cursor on a CoroutineScheduler, the claimed
+ *  slots are then published as usual.
+ */
+template <typename Producer>
+class AsyncProducer {
+ public:
+  class ClaimAwaiter : public detail::RingAwaiter {
+   public:
+    ClaimAwaiter(CoroutineScheduler& scheduler, Producer& producer,
+                 int64_t num)
+        : RingAwaiter(scheduler), producer_(producer), num_(num) {}
+
+    bool ready() override {
+      pos_ = producer_.try_next(num_);
+      return pos_ != kInsufficientCapacity;
+    }
+
+    bool await_ready() { return ready(); }
+    void await_suspend(std::coroutine_handle<> handle) { suspend(handle); }
+    int64_t await_resume() const { return pos_; }
+
+   private:
+    Producer& producer_;
+    const int64_t num_;
+    int64_t pos_ = kInsufficientCapacity;
+  };
+
+  AsyncProducer(CoroutineScheduler& scheduler,
+                std::shared_ptr<Producer> producer)
+      : scheduler_(scheduler), producer_(std::move(producer)) {}
+
+  /**
+   *  co_await suspends until num slots are free.
+   *
+   *  @return the last claimed slot, or kEof / kHalted, see Producer::next()
+   */
+  ClaimAwaiter claim(int64_t num = 1) {
+    return ClaimAwaiter(scheduler_, *producer_, num);
+  }
+
+ private:
+  CoroutineScheduler& scheduler_;
+  std::shared_ptr<Producer> producer_;
+};
+
+}  // namespace disruptor
+
+#endif  // __cpp_impl_coroutine
@@ -4,31 +4,103 @@
 //
 #pragma once
 
+#include <disruptor/availability_buffer.h>
 #include <disruptor/eof.h>
 #include <disruptor/sequence.h>
+#include <disruptor/wait_strategy.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace disruptor {
 
 /**
  *   A barrier will block until all cursors it is following are
- *   have moved past a given position.  The barrier uses a
- *   progressive backoff strategy of busy waiting for 1000
- *   tries, yielding for 1000 tries, and the usleeping in 10 ms
- *   intervals.
+ *   have moved past a given position.  How the barrier idles in
+ *   the mean time is up to the WaitStrategy, by default it yields
+ *   for 10000 tries and then usleeps with an exponential backoff
+ *   capped at 10 ms.
  *
- *   No wait conditions or locks are used because they would
- *   be 'intrusive' to publishers which must check to see whether
- *   or not they must 'notify'.  The progressive backoff approach
- *   uses little CPU and is a good compromise for most use cases.
+ *   The progressive backoff approach uses little CPU and is a good
+ *   compromise for most use cases.  BlockingWaitStrategy avoids
+ *   polling entirely, but is 'intrusive' to publishers which must
+ *   then check to see whether or not they must 'notify'.
+ *
+ *   Cursors shared by several producers are only an upper bound, the
+ *   barrier scans their AvailabilityBuffer for the highest position
+ *   that has been published without gaps.
+ *
+ *   A producer gating on many consumers scans them all on every wrap
+ *   check that misses the cached minimum.  The barrier keeps a flat array
+ *   of the raw cursor pointers for that scan, and takes the minimum over
+ *   several independent loads at a time so that the cache misses on the
+ *   cursors overlap instead of being paid one after the other.
+ *
+ *   The cursors followed may change while the barrier is in use.  The set
+ *   is copied on write and swapped in atomically, readers only register
+ *   while they scan it and never take a lock.
+ *
+ *   A producer that must not be held back by a slow consumer follows it
+ *   with a lag limit.  Once the consumer falls further behind, the
+ *   producer evicts it from the set and marks it overrun, see
+ *   evict_laggards().
  */
 class Barrier {
  public:
-  void follow(std::shared_ptr<const Sequence> e) {
-    limit_seq_.push_back(std::move(e));
+  /** a cursor followed without a lag limit is always waited for */
+  static constexpr int64_t kNoLagLimit = 0x7fffffffffffffff;
+
+  Barrier() : current_(new Gating), gating_(current_.get()) {}
+
+  Barrier(const Barrier&) = delete;
+  Barrier& operator=(const Barrier&) = delete;
+
+  /**
+   *  Starts following e, also while the barrier is in use.  A cursor that
+   *  joins a running stream must not be behind the ones already followed,
+   *  see EventCursor::join().
+   *
+   *  @param max_lag - how many positions e may fall behind before it is
+   *  evicted, must be below the size of the buffer to take effect
+   */
+  void follow(std::shared_ptr<const Sequence> e,
+              int64_t max_lag = kNoLagLimit) {
+    update([&](Gating& gating) {
+      gating.dependencies.push_back(
+          std::make_shared<Dependency>(std::move(e), max_lag));
+    });
+  }
+
+  /**
+   *  Stops following s, also while the barrier is in use, e.g. to detach a
+   *  consumer that is too slow or gone.
+   *
+   *  @return false if s was not followed
+   */
+  bool unfollow(const Sequence& s) {
+    bool found = false;
+    update([&](Gating& gating) {
+      auto& dependencies = gating.dependencies;
+      auto itr = std::find_if(dependencies.begin(), dependencies.end(),
+                              [&](const std::shared_ptr<Dependency>& d) {
+                                return d->seq.get() == &s;
+                              });
+      if (itr == dependencies.end()) return;
+      dependencies.erase(itr);
+      found = true;
+    });
+    return found;
+  }
+
+  /** @return how many cursors this barrier follows */
+  size_t size() const {
+    ReadGuard guard(*this);
+    return guard->dependencies.size();
   }
 
   /**
@@ -37,59 +109,321 @@ class Barrier {
    *  @return the min position of every cusror this barrier follow.
    */
   int64_t get_min(int64_t pos) {
-    if (last_min_ > pos) return last_min_;
+    auto last_min = last_min_.load(std::memory_order_relaxed);
+    if (last_min > pos) return last_min;
 
+    ReadGuard guard(*this);
     int64_t min_pos = 0x7fffffffffffffff;
-    for (auto& itr : limit_seq_) {
-      auto itr_pos = itr->acquire();
-      if (itr_pos < min_pos) min_pos = itr_pos;
+    if (!guard->scan_availability) {
+      min_pos = min_of(guard->cursors.data(), guard->cursors.size());
+    } else {
+      for (const auto& dependency : guard->dependencies) {
+        auto itr_pos = published(*dependency, 0);
+        if (itr_pos < min_pos) min_pos = itr_pos;
+      }
+    }
+    last_min_.store(min_pos, std::memory_order_relaxed);
+    return min_pos;
+  }
+
+  /**
+   *  Stops following, and marks overrun, every cursor that lags more than
+   *  its max_lag behind pos.  A producer calls it with the last position it
+   *  claimed, the slots an evicted consumer has yet to read may be
+   *  overwritten right after.
+   *
+   *  @return the claim position past which another check is due, i.e.
+   *  where the closest of the remaining lag limited cursors falls too far
+   *  behind, kNoLagLimit if none is
+   */
+  int64_t evict_laggards(int64_t pos) {
+    if (!lag_limited_.load(std::memory_order_relaxed)) return kNoLagLimit;
+
+    while (true) {
+      const Sequence* laggard = nullptr;
+      int64_t due = kNoLagLimit;
+      {
+        ReadGuard guard(*this);
+        for (const auto& dependency : guard->dependencies) {
+          if (dependency->max_lag == kNoLagLimit) continue;
+          auto dependency_pos = published(*dependency, 0);
+          if (pos - dependency_pos > dependency->max_lag) {
+            laggard = dependency->seq.get();
+            laggard->mark_overrun();
+            break;
+          }
+          due = std::min(due, dependency_pos + dependency->max_lag);
+        }
+      }
+      if (laggard == nullptr) return due;
+      // only compares the address, the laggard may be gone already
+      unfollow(*laggard);
     }
-    return last_min_ = min_pos;
+  }
+
+  /** @return whether any cursor this barrier follows was halted */
+  bool halted() const {
+    ReadGuard guard(*this);
+    for (const auto& dependency : guard->dependencies) {
+      if (dependency->seq->halted()) return true;
+    }
+    return false;
   }
 
   /*
-   *  This method will wait until all s in seq >= pos using a progressive
-   *  backoff of busy wait, yield, and usleep(10*1000)
+   *  This method will wait until all s in seq >= pos using the default
+   *  progressive backoff of yield and usleep
    *
    *  @return the minimum value of every dependency
    */
   int64_t wait_for(int64_t pos) const {
-    if (last_min_ > pos) return last_min_;
+    SleepingWaitStrategy wait_strategy;
+    return wait_for(pos, wait_strategy);
+  }
+
+  /*
+   *  Like wait_for(), but returns right away, with a position below pos
+   *  when some dependency has not reached it yet.
+   *
+   *  @return the minimum value of every dependency
+   */
+  int64_t try_wait_for(int64_t pos) const {
+    NoWaitStrategy wait_strategy;
+    return wait_for(pos, wait_strategy);
+  }
+
+  /*
+   *  This method will wait until all s in seq >= pos, idling as
+   *  wait_strategy sees fit
+   *
+   *  @return the minimum value of every dependency, kEof once a dependency
+   *  ended and everything it published before is consumed, kHalted as soon
+   *  as a dependency is halted
+   */
+  template <typename WaitStrategy>
+  int64_t wait_for(int64_t pos, WaitStrategy& wait_strategy) const {
+    return wait_for(pos, wait_strategy, true);
+  }
 
+  /**
+   *  Like wait_for(), for followers that wait for positions out of order,
+   *  e.g. the workers of a WorkerPool.  Positions below pos are not assumed
+   *  to be published, what is available from pos on is only published
+   *  without gaps from pos on.
+   */
+  template <typename WaitStrategy>
+  int64_t wait_for_unordered(int64_t pos, WaitStrategy& wait_strategy) const {
+    return wait_for(pos, wait_strategy, false);
+  }
+
+  /** like wait_for_unordered(), but returns right away */
+  int64_t try_wait_for_unordered(int64_t pos) const {
+    NoWaitStrategy wait_strategy;
+    return wait_for(pos, wait_strategy, false);
+  }
+
+ private:
+  struct NoWaitStrategy {
+    template <typename Ready>
+    void wait(const Sequence&, Ready&&) {}
+  };
+
+  struct Dependency;
+  typedef std::vector<std::shared_ptr<Dependency>> Dependencies;
+
+  /** returned by a scan that would have to wait */
+  static constexpr int64_t kWouldWait = -0x7fffffffffffffff - 1;
+
+  /** @param ordered - everything below pos is published, as it is for a
+   *  consumer that already consumed it */
+  template <typename WaitStrategy>
+  int64_t wait_for(int64_t pos, WaitStrategy& wait_strategy,
+                   bool ordered) const {
+    auto last_min = last_min_.load(std::memory_order_relaxed);
+    if (last_min > pos) return last_min;
+
+    static constexpr bool kBlocks =
+        !std::is_same<WaitStrategy, NoWaitStrategy>::value;
+    Dependencies dependencies;
+    {
+      ReadGuard guard(*this);
+      auto min_pos = scan(guard->dependencies, pos, wait_strategy, ordered,
+                          !kBlocks, guard->scan_availability);
+      if (min_pos != kWouldWait) return min_pos;
+      // about to wait, maybe for long: hold on to the dependencies rather
+      // than to the gating set, which updates could then never free
+      dependencies = guard->dependencies;
+    }
+    bool scan_availability = false;
+    for (const auto& dependency : dependencies) {
+      if (dependency->seq->availability() != nullptr) scan_availability = true;
+    }
+    return scan(dependencies, pos, wait_strategy, ordered, true,
+                scan_availability);
+  }
+
+  /** the body of wait_for() over a snapshot of the dependencies
+   *  @return kWouldWait if a dependency is behind pos and not may_wait */
+  template <typename WaitStrategy>
+  int64_t scan(const Dependencies& dependencies, int64_t pos,
+               WaitStrategy& wait_strategy, bool ordered, bool may_wait,
+               bool scan_availability) const {
     int64_t min_pos = 0x7fffffffffffffff;
-    for (const auto& itr : limit_seq_) {
-      int64_t itr_pos = itr->acquire();
-
-      // yield for a while, queue slowing down
-      for (int y = 0; itr_pos < pos && y < 10000; ++y) {
-        std::this_thread::yield();
-        itr_pos = itr->acquire();
-        if (itr->eof()) break;
-      }
+    for (const auto& dependency : dependencies) {
+      const auto& itr = dependency->seq;
+      int64_t itr_pos = published(*dependency, pos, ordered);
 
-      // queue stalled, don't peg the CPU but don't wait
-      // too long either...
-      while (itr_pos < pos) {
-        usleep(10 * 1000);
-        itr_pos = itr->acquire();
-        if (itr->eof()) break;
+      if (itr_pos < pos && !itr->eof()) {
+        if (!may_wait) return kWouldWait;
+        wait_strategy.wait(*itr, [&] {
+          itr_pos = published(*dependency, pos, ordered);
+          return itr_pos >= pos || itr->eof();
+        });
       }
 
       if (itr->eof()) {
-        if (itr_pos > pos)
-          return itr_pos - 1;  // process everything up to itr_pos
-        throw Eof();
+        if (itr->halted()) return kHalted;
+        // everything published before set_eof() is still processed
+        itr_pos = published(*dependency, pos, ordered);
+        if (itr_pos < pos) return kEof;
       }
 
       if (itr_pos < min_pos) min_pos = itr_pos;
     }
     assert(min_pos != 0x7fffffffffffffff);
-    return last_min_ = min_pos;
+    // out of order, min_pos says nothing about the positions below pos
+    if (ordered || !scan_availability)
+      last_min_.store(min_pos, std::memory_order_relaxed);
+    return min_pos;
   }
 
- private:
-  mutable int64_t last_min_{};
-  std::vector<std::shared_ptr<const Sequence>> limit_seq_;
+  struct Dependency {
+    Dependency(std::shared_ptr<const Sequence> s, int64_t lag)
+        : seq(std::move(s)), max_lag(lag), published(seed(*seq)) {}
+
+    /**
+     *  Every position a full ring behind the claims is published: no
+     *  producer could have claimed past an unpublished slot by a whole
+     *  lap.  A cursor followed mid stream, see EventCursor::join(), then
+     *  only scans the last lap instead of everything since the start.
+     */
+    static int64_t seed(const Sequence& s) {
+      auto availability = s.availability();
+      if (availability == nullptr) return Sequence::INIT_SEQUENCE;
+      return std::max<int64_t>(int64_t{Sequence::INIT_SEQUENCE},
+                               s.acquire() - availability->size());
+    }
+
+    std::shared_ptr<const Sequence> seq;
+    const int64_t max_lag;
+    // how far an AvailabilityBuffer is known to be published without gaps,
+    // so the next scan starts there.  Racing updates may move it back,
+    // which only costs a longer scan.
+    mutable std::atomic<int64_t> published;
+  };
+
+  /** the cursors followed, never modified once published in gating_ */
+  struct Gating {
+    std::vector<std::shared_ptr<Dependency>> dependencies;
+    // the cursors of dependencies, scanned directly unless any of them
+    // needs its availability checked
+    std::vector<const Sequence*> cursors;
+    bool scan_availability = false;
+  };
+
+  /** pins the gating set a reader is using until it is done with it */
+  class ReadGuard {
+   public:
+    explicit ReadGuard(const Barrier& barrier) : barrier_(barrier) {
+      barrier_.readers_.fetch_add(1, std::memory_order_seq_cst);
+      gating_ = barrier_.gating_.load(std::memory_order_seq_cst);
+    }
+    ~ReadGuard() { barrier_.readers_.fetch_sub(1, std::memory_order_release); }
+
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
+    const Gating* operator->() const { return gating_; }
+
+   private:
+    const Barrier& barrier_;
+    const Gating* gating_;
+  };
+
+  /**
+   *  Copies the gating set, modifies the copy and swaps it in.  Readers
+   *  never wait: the sets they may still be scanning are retired and only
+   *  freed by an update that finds no reader inside the barrier.
+   */
+  template <typename Modify>
+  void update(Modify&& modify) {
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    std::unique_ptr<Gating> next(new Gating);
+    next->dependencies = current_->dependencies;
+    modify(*next);
+    bool lag_limited = false;
+    for (const auto& dependency : next->dependencies) {
+      next->cursors.push_back(dependency->seq.get());
+      if (dependency->seq->availability() != nullptr)
+        next->scan_availability = true;
+      if (dependency->max_lag != kNoLagLimit) lag_limited = true;
+    }
+    lag_limited_.store(lag_limited, std::memory_order_relaxed);
+
+    retired_.push_back(std::move(current_));
+    current_ = std::move(next);
+    gating_.store(current_.get(), std::memory_order_seq_cst);
+    if (readers_.load(std::memory_order_seq_cst) == 0) retired_.clear();
+  }
+
+  /** @return the lowest of n cursors, loading 4 of them at a time */
+  static int64_t min_of(const Sequence* const* cursors, size_t n) {
+    int64_t min0 = 0x7fffffffffffffff;
+    size_t i = 0;
+    if (n >= 4) {
+      int64_t min1 = min0;
+      int64_t min2 = min0;
+      int64_t min3 = min0;
+      for (; i + 4 <= n; i += 4) {
+        min0 = std::min(min0, cursors[i]->acquire());
+        min1 = std::min(min1, cursors[i + 1]->acquire());
+        min2 = std::min(min2, cursors[i + 2]->acquire());
+        min3 = std::min(min3, cursors[i + 3]->acquire());
+      }
+      min0 = std::min(std::min(min0, min1), std::min(min2, min3));
+    }
+    for (; i < n; ++i) min0 = std::min(min0, cursors[i]->acquire());
+    return min0;
+  }
+
+  /**
+   *  @return how far the dependency has published, given everything
+   *  before pos is already known to be when ordered.  Otherwise only from
+   *  pos on, and the scan only becomes a hint for later scans if it
+   *  started where the hint left off.
+   */
+  static int64_t published(const Dependency& dependency, int64_t pos,
+                           bool ordered = true) {
+    auto seq_pos = dependency.seq->acquire();
+    auto availability = dependency.seq->availability();
+    if (availability == nullptr) return seq_pos;
+
+    auto known = dependency.published.load(std::memory_order_relaxed);
+    auto begin = std::max(known + 1, pos);
+    auto highest = availability->highest_published(begin, seq_pos);
+    if (highest > known && (ordered || begin == known + 1))
+      dependency.published.store(highest, std::memory_order_relaxed);
+    return highest;
+  }
+
+  // several producers may share the barrier of a MultiProducerSequencer
+  mutable std::atomic<int64_t> last_min_{0};
+  mutable std::atomic<int> readers_{0};
+  std::atomic<bool> lag_limited_{false};
+  std::unique_ptr<const Gating> current_;
+  std::atomic<const Gating*> gating_;
+  std::vector<std::unique_ptr<const Gating>> retired_;
+  std::mutex update_mutex_;
 };
 
 }  // namespace disruptor
@@ -0,0 +1,156 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#include <disruptor/consumer_sequencer.h>
+#include <disruptor/eof.h>
+#include <disruptor/event_translator.h>
+#include <disruptor/exceptions.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace disruptor {
+
+namespace detail {
+
+template <typename T, typename = void>
+struct has_before_publish : std::false_type {};
+
+template <typename T>
+struct has_before_publish<
+    T, decltype(std::declval<T&>().before_publish(int64_t{}), void())>
+    : std::true_type {};
+
+template <typename Handler>
+void before_publish(Handler& handler, int64_t pos, std::true_type) {
+  handler.before_publish(pos);
+}
+
+template <typename Handler>
+void before_publish(Handler&, int64_t, std::false_type) {}
+
+}  // namespace detail
+
+struct BatchOptions {
+  /** the most events handed to the handler before end_of_batch, 0 hands
+   *  over everything available */
+  int64_t max_batch_size = 0;
+  /** publish progress every this many events within a batch so the
+   *  producer can reuse their slots, 0 only publishes at the end.  A
+   *  handler with before_publish(pos) is called before every publish. */
+  int64_t publish_interval = 0;
+  /** clear_event() every event once handled, for the last consumer of
+   *  events that own memory */
+  bool clear_events = false;
+};
+
+/**
+ *  Runs the consumer loop of a cursor: waits for events, hands every one
+ *  of them to handler.on_event(event, pos, end_of_batch) and publishes the
+ *  progress.
+ *
+ *  end_of_batch is set on the last event available at the time, which is
+ *  the moment to flush whatever the handler buffered, so writes and
+ *  syscalls are amortized over the whole batch.  A handler that must
+ *  finish something before the consumers following it see an event, e.g.
+ *  make it durable, also defines before_publish(pos), which is called
+ *  before progress up to pos is published, also within a batch.
+ *
+ *  @code
+ *  struct Journal {
+ *    void on_event(const Event& event, int64_t pos, bool end_of_batch) {
+ *      buffer.append(event);
+ *      if (end_of_batch) flush(buffer);
+ *    }
+ *  };
+ *
+ *  auto processor = make_batch_event_processor(ring, consumer, Journal{});
+ *  std::thread journal([&] { processor.run(); });
+ *  @endcode
+ *
+ *  Works with any ring buffer and any consumer cursor, e.g. a
+ *  BasicConsumerSequencer, which must be wired before run().
+ */
+template <typename Ring, typename Handler,
+          typename Consumer = ConsumerSequencer>
+class BatchEventProcessor {
+ public:
+  BatchEventProcessor(std::shared_ptr<Ring> ring,
+                      std::shared_ptr<Consumer> consumer, Handler handler,
+                      BatchOptions options = {})
+      : ring_(std::move(ring)),
+        consumer_(std::move(consumer)),
+        handler_(std::move(handler)),
+        options_(options),
+        next_sequence_(consumer_->acquire() + 1) {
+    if (options_.max_batch_size < 0 || options_.publish_interval < 0)
+      detail::throw_exception<std::runtime_error>("batch options must be >= 0");
+  }
+
+  /** processes events until the cursors followed end, everything published
+   *  before set_eof() is processed, nothing more once halted */
+  void run() {
+    while (process_batch() >= 0) {
+    }
+  }
+
+  /**
+   *  Waits for the next events and processes one batch of them.
+   *
+   *  @return the number of events processed, or kEof / kHalted once the
+   *  stream ended
+   */
+  int64_t process_batch() {
+    auto begin = next_sequence_;
+    auto end = consumer_->wait_for(begin);
+    if (end < begin) return end;
+    if (options_.max_batch_size > 0)
+      end = std::min(end, begin + options_.max_batch_size - 1);
+
+    for (auto pos = begin; pos <= end; ++pos) {
+      handler_.on_event(ring_->at(pos), pos, pos == end);
+      if (options_.clear_events) clear_event(ring_->at(pos));
+      if (options_.publish_interval > 0 && pos != end &&
+          (pos - begin + 1) % options_.publish_interval == 0) {
+        publish(pos);
+      }
+    }
+    publish(end);
+    next_sequence_ = end + 1;
+    return end - begin + 1;
+  }
+
+  Handler& handler() { return handler_; }
+  const std::shared_ptr<Consumer>& consumer() const { return consumer_; }
+
+ private:
+  void publish(int64_t pos) {
+    detail::before_publish(handler_, pos,
+                           detail::has_before_publish<Handler>());
+    consumer_->publish(pos);
+  }
+
+  std::shared_ptr<Ring> ring_;
+  std::shared_ptr<Consumer> consumer_;
+  Handler handler_;
+  const BatchOptions options_;
+  int64_t next_sequence_;
+};
+
+template <typename Ring, typename Consumer, typename Handler>
+BatchEventProcessor<Ring, typename std::decay<Handler>::type, Consumer>
+make_batch_event_processor(std::shared_ptr<Ring> ring,
+                           std::shared_ptr<Consumer> consumer,
+                           Handler&& handler, BatchOptions options = {}) {
+  return {std::move(ring), std::move(consumer),
+          std::forward<Handler>(handler), options};
+}
+
+}  // namespace disruptor
@@ -0,0 +1,98 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <disruptor/sequence.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace disruptor {
+
+/**
+ *  A lossy ring for broadcasting to readers that must never hold the
+ *  producer back, e.g. market data fanned out to many subscribers.
+ *
+ *  The producer does not follow the readers at all, it overwrites the
+ *  oldest slot whatever the readers have left to read.  Every slot carries
+ *  the position it was last written for, a reader compares that stamp
+ *  before and after copying the event out to find out whether it was
+ *  overwritten in the mean time, and then skips ahead to oldest().
+ *
+ *  @code
+ *  auto pos = producer->next();
+ *  ring->write(pos, event);
+ *  producer->publish(pos);
+ *
+ *  auto available_sequence = reader->wait_for(next_sequence);
+ *  for (; next_sequence <= available_sequence; ++next_sequence) {
+ *    if (!ring->read(next_sequence, event)) {
+ *      next_sequence = ring->oldest(producer->acquire()) - 1;
+ *      continue;
+ *    }
+ *    ...
+ *  }
+ *  @endcode
+ *
+ *  Events are copied in and out, so EventType must be trivially copyable.
+ */
+template <typename EventType, uint64_t Size = 1024>
+class BroadcastRingBuffer {
+ public:
+  typedef EventType event_type;
+
+  static_assert(((Size != 0) && ((Size & (~Size + 1)) == Size)),
+                "Ring buffer's must be a power of 2");
+  static_assert(std::is_trivially_copyable<EventType>::value,
+                "Broadcast events are copied while they may be overwritten");
+
+  /**
+   *  Writes event into the slot of pos, a single producer only.  Readers
+   *  see it once the producer publishes pos.
+   */
+  void write(int64_t pos, const EventType& event) {
+    auto& slot = _buffer[pos & (Size - 1)];
+    slot.stamp.store(kWriting, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.event, &event, sizeof(EventType));
+    slot.stamp.store(pos, std::memory_order_release);
+  }
+
+  /**
+   *  Copies the event at pos into event.
+   *
+   *  @return false if the producer has overwritten pos, before or while it
+   *  was copied, event is garbage then
+   */
+  bool read(int64_t pos, EventType& event) const {
+    const auto& slot = _buffer[pos & (Size - 1)];
+    if (slot.stamp.load(std::memory_order_acquire) != pos) return false;
+    std::memcpy(&event, &slot.event, sizeof(EventType));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.stamp.load(std::memory_order_relaxed) == pos;
+  }
+
+  /** @return the oldest position that may still be read while the
+   *  producer has published up to cursor */
+  static int64_t oldest(int64_t cursor) {
+    return std::max<int64_t>(0, cursor - static_cast<int64_t>(Size) + 1);
+  }
+
+  int64_t size() const { return Size; }
+
+ private:
+  static constexpr int64_t kWriting = -1;
+
+  struct Slot {
+    std::atomic<int64_t> stamp{kWriting};
+    EventType event;
+  };
+
+  Slot _buffer[Size];
+};
+
+}  // namespace disruptor
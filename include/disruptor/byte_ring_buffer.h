@@ -0,0 +1,208 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <disruptor/dynamic_ring_buffer.h>
+#include <disruptor/exceptions.h>
+#include <disruptor/span.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace disruptor {
+
+/**
+ *  A ring of variable length messages, framed in a buffer of bytes.
+ *
+ *  Sequencer positions count bytes instead of slots, so the producer and
+ *  consumers are the usual sequencers constructed with size() and the
+ *  handoff is unchanged, while memory use follows the payload instead of
+ *  the largest message.  Every message is a record of an 8 byte header
+ *  followed by the payload, padded to 8 bytes.  Records never wrap: a
+ *  message that does not fit before the end of the buffer is preceded by
+ *  a padding record, which readers skip.
+ *
+ *  @code
+ *  ByteRingBuffer ring(1 << 20);
+ *  auto producer = std::make_shared<SingleProducerSequencer>(ring.size());
+ *
+ *  auto claim = ring.claim(*producer, length);
+ *  memcpy(claim.data.data, payload, length);
+ *  producer->publish(claim.end);
+ *
+ *  auto available = consumer->wait_for(next_sequence);
+ *  for (auto message : ring.messages(next_sequence, available)) {
+ *    handle(message.data, message.size);
+ *  }
+ *  consumer->publish(available);
+ *  next_sequence = available + 1;
+ *  @endcode
+ *
+ *  Claims are made in two steps when a record wraps, so the ring only
+ *  supports a single producer.
+ */
+class ByteRingBuffer {
+ public:
+  static constexpr size_t kAlignment = 8;
+
+  /** room for a message, write it to data and publish end */
+  struct Claim {
+    Span<char> data;
+    int64_t end;
+  };
+
+  /** the messages in a published range, as zero-copy views of the ring */
+  class MessageRange {
+   public:
+    class iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = Span<const char>;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const value_type*;
+      using reference = value_type;
+
+      iterator(const ByteRingBuffer* ring, int64_t pos, int64_t end)
+          : ring_(ring), pos_(pos), end_(end) {
+        skip_padding();
+      }
+
+      Span<const char> operator*() const {
+        auto header = ring_->header(pos_);
+        return {reinterpret_cast<const char*>(header + 1), header->length};
+      }
+
+      iterator& operator++() {
+        pos_ += record_bytes(ring_->header(pos_)->length);
+        skip_padding();
+        return *this;
+      }
+
+      bool operator==(const iterator& other) const {
+        return pos_ == other.pos_;
+      }
+      bool operator!=(const iterator& other) const {
+        return pos_ != other.pos_;
+      }
+
+     private:
+      void skip_padding() {
+        while (pos_ <= end_ && ring_->header(pos_)->type == kPadding) {
+          pos_ += record_bytes(ring_->header(pos_)->length);
+        }
+      }
+
+      const ByteRingBuffer* ring_;
+      int64_t pos_;
+      int64_t end_;
+    };
+
+    iterator begin() const { return {ring_, begin_, end_}; }
+    iterator end() const { return {ring_, end_ + 1, end_}; }
+
+   private:
+    friend class ByteRingBuffer;
+    MessageRange(const ByteRingBuffer* ring, int64_t begin, int64_t end)
+        : ring_(ring), begin_(begin), end_(end) {}
+
+    const ByteRingBuffer* ring_;
+    int64_t begin_;
+    int64_t end_;
+  };
+
+  /** @param size - the size of the ring in bytes, must be a power of 2 */
+  explicit ByteRingBuffer(int64_t size, RingBufferOptions options = {})
+      : buffer_(size, options) {
+    if (size < 4 * static_cast<int64_t>(kAlignment))
+      detail::throw_exception<std::runtime_error>("byte ring too small");
+  }
+
+  int64_t size() const { return buffer_.size(); }
+
+  /** messages are limited to half the ring so that a claim made right
+   *  after a wrap always fits */
+  size_t max_message_size() const {
+    return static_cast<size_t>(size()) / 2 - sizeof(RecordHeader);
+  }
+
+  /** @return the bytes a message of length bytes takes up in the ring */
+  static size_t record_bytes(size_t length) {
+    return (sizeof(RecordHeader) + length + kAlignment - 1) / kAlignment *
+           kAlignment;
+  }
+
+  /**
+   *  Claims room for a message of length bytes from producer, waiting for
+   *  room like producer.next() does.  Publishing claim.end makes the
+   *  message, and any padding in front of it, visible to followers.
+   *
+   *  @param producer - the single producer of this ring, e.g. a
+   *  SingleProducerSequencer constructed with size()
+   *  @return the claim, with a negative end and no data if producer.next()
+   *  returned kHalted
+   */
+  template <typename Producer>
+  Claim claim(Producer& producer, size_t length) {
+    if (length > max_message_size())
+      detail::throw_exception<std::runtime_error>(
+          "message larger than half the ring");
+    auto bytes = static_cast<int64_t>(record_bytes(length));
+
+    auto end = producer.next(bytes);
+    if (end < 0) return {{}, end};
+    auto begin = end - bytes + 1;
+    auto tail = size() - buffer_.index(begin);
+    if (tail < bytes) {
+      // pad up to the end of the buffer and over the part claimed at its
+      // start, the next claim then begins with a contiguous run of at
+      // least half the ring
+      pad(begin, tail);
+      pad(begin + tail, bytes - tail);
+      end = producer.next(bytes);
+      if (end < 0) return {{}, end};
+      begin = end - bytes + 1;
+    }
+
+    auto header = this->header(begin);
+    header->length = static_cast<uint32_t>(length);
+    header->type = kMessage;
+    return {{reinterpret_cast<char*>(header + 1), length}, end};
+  }
+
+  /** @return the messages published in [begin, end], begin must be the
+   *  start of a record, i.e. one past the end of the previous range */
+  MessageRange messages(int64_t begin, int64_t end) const {
+    return {this, begin, end};
+  }
+
+ private:
+  enum RecordType : uint32_t { kMessage = 0, kPadding = 1 };
+
+  struct RecordHeader {
+    uint32_t length;
+    uint32_t type;
+  };
+  static_assert(sizeof(RecordHeader) == kAlignment,
+                "records are made of 8 byte words");
+
+  RecordHeader* header(int64_t pos) {
+    return reinterpret_cast<RecordHeader*>(&buffer_.at(pos));
+  }
+  const RecordHeader* header(int64_t pos) const {
+    return reinterpret_cast<const RecordHeader*>(&buffer_.at(pos));
+  }
+
+  void pad(int64_t pos, int64_t bytes) {
+    auto header = this->header(pos);
+    header->length = static_cast<uint32_t>(bytes - sizeof(RecordHeader));
+    header->type = kPadding;
+  }
+
+  DynamicRingBuffer<char> buffer_;
+};
+
+}  // namespace disruptor
@@ -6,22 +6,88 @@
 
 #include <disruptor/eof.h>
 #include <disruptor/event_cursor.h>
+#include <disruptor/wait_strategy.h>
+
+#include <limits>
+#include <utility>
 
 namespace disruptor {
 
 /**
- *  Tracks the read position in a buffer
+ *  Tracks the read position in a buffer, waiting for the cursors it
+ *  follows with WaitStrategy.  Any constructor arguments are forwarded
+ *  to the wait strategy.
  */
-class ConsumerSequencer : public EventCursor {
+template <typename WaitStrategy>
+class BasicConsumerSequencer : public EventCursor {
  public:
+  template <typename... Args>
+  explicit BasicConsumerSequencer(Args&&... args)
+      : wait_strategy_(std::forward<Args>(args)...) {
+#if DISRUPTOR_TELEMETRY
+    wait_strategy_.bind(telemetry_);
+#endif
+  }
+
+  template <typename T>
+  void follow(T&& s) {
+    wait_strategy_.attach(*s);
+    EventCursor::follow(std::forward<T>(s));
+  }
+
+  /**
+   *  Joins a stream that is already flowing: moves this cursor up to the
+   *  cursors it follows, skipping what they published so far.  Call it
+   *  once follow() is done and before the producer follows this consumer,
+   *  which can then happen at any time.
+   *
+   *  @code
+   *  tap->follow(producer);
+   *  auto next_sequence = tap->join() + 1;
+   *  producer->follow(tap);
+   *  @endcode
+   *
+   *  A consumer evicted for lagging too far behind joins again the same way,
+   *  which clears its overrun().
+   *
+   *  @return the last position skipped
+   */
+  int64_t join() {
+    clear_overrun();
+    auto pos = barrier_.get_min(std::numeric_limits<int64_t>::max());
+    publish(pos);
+    return pos;
+  }
+
+  /**
+   *  @return the highest position available, or kEof / kHalted once the
+   *  stream ended, which is passed on to those following this cursor.
+   *  kOverrun once the producer evicted this consumer, which is not passed
+   *  on: the consumer may join() again.
+   */
   int64_t wait_for(int64_t next_sequence) {
-    try {
-      return barrier_.wait_for(next_sequence);
-    } catch (...) {
-      set_eof();
-      throw;
-    }
+    auto available = barrier_.wait_for(next_sequence, wait_strategy_);
+    if (overrun()) return kOverrun;
+    if (available >= next_sequence)
+      telemetry_.record_batch(available - next_sequence + 1);
+    return forward_end(available);
+  }
+
+  /** like wait_for(), but returns right away
+   *  @return the highest position available, below next_sequence if there
+   *  is nothing to process yet */
+  int64_t try_wait_for(int64_t next_sequence) {
+    auto available = barrier_.try_wait_for(next_sequence);
+    if (overrun()) return kOverrun;
+    if (available >= next_sequence)
+      telemetry_.record_batch(available - next_sequence + 1);
+    return forward_end(available);
   }
+
+ private:
+  WaitStrategy wait_strategy_;
 };
 
+using ConsumerSequencer = BasicConsumerSequencer<SleepingWaitStrategy>;
+
 }  // namespace disruptor
@@ -1,6 +1,22 @@
 #pragma once
 
+#include <disruptor/awaitable.h>
+#include <disruptor/batch_event_processor.h>
+#include <disruptor/broadcast_ring_buffer.h>
+#include <disruptor/byte_ring_buffer.h>
 #include <disruptor/consumer_sequencer.h>
+#include <disruptor/dynamic_ring_buffer.h>
+#include <disruptor/event_translator.h>
+#include <disruptor/eventfd_notifier.h>
+#include <disruptor/journal.h>
 #include <disruptor/multi_producer_sequencer.h>
+#include <disruptor/placement.h>
 #include <disruptor/ring_buffer.h>
+#include <disruptor/shared_memory_ring.h>
+#include <disruptor/sharded_ring.h>
 #include <disruptor/single_producer_sequencer.h>
+#include <disruptor/spsc_channel.h>
+#include <disruptor/telemetry.h>
+#include <disruptor/topology.h>
+#include <disruptor/wait_strategy.h>
+#include <disruptor/worker_pool.h>
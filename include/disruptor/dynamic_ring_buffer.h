@@ -0,0 +1,200 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <disruptor/exceptions.h>
+#include <disruptor/placement.h>
+#include <disruptor/span.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+namespace disruptor {
+
+struct RingBufferOptions {
+  /** back the storage with explicit huge pages (MAP_HUGETLB), falling back
+   *  to transparent huge pages when none are reserved */
+  bool huge_pages = false;
+  /** touch every page at construction instead of on first use */
+  bool prefault = true;
+  /** bind the storage to this NUMA node, -1 leaves placement to the kernel */
+  int numa_node = -1;
+};
+
+/**
+ *  A RingBuffer whose power of 2 size is chosen at runtime.
+ *
+ *  The events live in their own page aligned mapping rather than inline,
+ *  which keeps multi-megabyte rings out of the heap and lets them use huge
+ *  pages to cut TLB misses.  With prefault the page faults are all taken
+ *  in the constructor instead of as latency spikes on the first lap.
+ */
+template <typename EventType>
+class DynamicRingBuffer {
+ public:
+  typedef EventType event_type;
+
+  explicit DynamicRingBuffer(int64_t size, RingBufferOptions options = {})
+      : mask_(to_mask(size)) {
+    map(options);
+    construct([](void* slot) { new (slot) EventType(); });
+  }
+
+  /** builds every slot from factory() once, e.g. with reserved capacity,
+   *  see publish_event() */
+  template <typename Factory>
+  DynamicRingBuffer(int64_t size, Factory&& factory,
+                    RingBufferOptions options = {})
+      : mask_(to_mask(size)) {
+    map(options);
+    construct([&](void* slot) { new (slot) EventType(factory()); });
+  }
+
+  ~DynamicRingBuffer() { destroy(size()); }
+
+  DynamicRingBuffer(const DynamicRingBuffer&) = delete;
+  DynamicRingBuffer& operator=(const DynamicRingBuffer&) = delete;
+
+  /** @return a read-only reference to the event at pos */
+  const EventType& at(int64_t pos) const { return _buffer[pos & mask_]; }
+  const EventType& operator[](int64_t pos) const {
+    return _buffer[pos & mask_];
+  }
+
+  /** @return a reference to the event at pos */
+  EventType& at(int64_t pos) { return _buffer[pos & mask_]; }
+  EventType& operator[](int64_t pos) { return _buffer[pos & mask_]; }
+
+  int64_t index(int64_t pos) const { return pos & mask_; }
+  int64_t size() const { return mask_ + 1; }
+
+  /** the events [pos, pos + count) as at most two contiguous ranges */
+  SpanPair<EventType> spans(int64_t pos, int64_t count) {
+    return make_span_pair(_buffer, size(), pos, count);
+  }
+  SpanPair<const EventType> spans(int64_t pos, int64_t count) const {
+    return make_span_pair<const EventType>(_buffer, size(), pos, count);
+  }
+
+  /** the mapping backing the events, page aligned */
+  void* data() const { return mapping_; }
+  size_t bytes() const { return mapping_bytes_; }
+
+  /** @return whether explicit huge pages back the storage */
+  bool huge_pages() const { return huge_pages_; }
+
+ private:
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+  static int64_t to_mask(int64_t size) {
+    if (size < 1 || (size & (size - 1)) != 0)
+      detail::throw_exception<std::runtime_error>(
+          "Ring buffer's must be a power of 2");
+    return size - 1;
+  }
+
+  static size_t round_up(size_t bytes, size_t alignment) {
+    return (bytes + alignment - 1) / alignment * alignment;
+  }
+
+  void map(const RingBufferOptions& options) {
+    static_assert(alignof(EventType) <= 4096,
+                  "events must not be aligned beyond a page");
+    auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto bytes = static_cast<size_t>(size()) * sizeof(EventType);
+
+    void* addr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (options.huge_pages) {
+      mapping_bytes_ = round_up(bytes, kHugePageSize);
+      addr = mmap(nullptr, mapping_bytes_, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      huge_pages_ = addr != MAP_FAILED;
+    }
+#endif
+
+    if (addr == MAP_FAILED && options.huge_pages) {
+      // over-allocate so the region can be trimmed to a huge page boundary,
+      // transparent huge pages are only used for aligned 2 MB extents
+      mapping_bytes_ = round_up(bytes, kHugePageSize);
+      auto raw_bytes = mapping_bytes_ + kHugePageSize;
+      auto raw = static_cast<char*>(mmap(nullptr, raw_bytes,
+                                         PROT_READ | PROT_WRITE,
+                                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+      if (raw != MAP_FAILED) {
+        auto begin = reinterpret_cast<char*>(
+            round_up(reinterpret_cast<uintptr_t>(raw), kHugePageSize));
+        if (begin != raw) munmap(raw, begin - raw);
+        auto tail = (raw + raw_bytes) - (begin + mapping_bytes_);
+        if (tail > 0) munmap(begin + mapping_bytes_, tail);
+        addr = begin;
+#ifdef MADV_HUGEPAGE
+        madvise(addr, mapping_bytes_, MADV_HUGEPAGE);
+#endif
+      }
+    }
+
+    if (addr == MAP_FAILED) {
+      mapping_bytes_ = round_up(bytes, page_size);
+      addr = mmap(nullptr, mapping_bytes_, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+
+    if (addr == MAP_FAILED) {
+      detail::throw_exception<std::system_error>(
+          errno, std::generic_category(), "ring buffer mmap");
+    }
+    mapping_ = addr;
+    _buffer = static_cast<EventType*>(addr);
+
+    if (options.numa_node >= 0) {
+      DISRUPTOR_TRY {
+        bind_to_numa_node(mapping_, mapping_bytes_, options.numa_node);
+      } DISRUPTOR_CATCH_ALL {
+        munmap(mapping_, mapping_bytes_);
+        DISRUPTOR_RETHROW;
+      }
+    }
+
+    if (options.prefault) {
+      auto step = huge_pages_ ? kHugePageSize : page_size;
+      auto bytes_ptr = static_cast<volatile char*>(mapping_);
+      for (size_t offset = 0; offset < mapping_bytes_; offset += step) {
+        bytes_ptr[offset] = 0;
+      }
+    }
+  }
+
+  template <typename Construct>
+  void construct(Construct&& construct_at) {
+    int64_t constructed = 0;
+    DISRUPTOR_TRY {
+      for (; constructed < size(); ++constructed) {
+        construct_at(&_buffer[constructed]);
+      }
+    } DISRUPTOR_CATCH_ALL {
+      destroy(constructed);
+      DISRUPTOR_RETHROW;
+    }
+  }
+
+  void destroy(int64_t constructed) {
+    for (int64_t i = 0; i < constructed; ++i) _buffer[i].~EventType();
+    munmap(mapping_, mapping_bytes_);
+  }
+
+  const int64_t mask_;
+  void* mapping_ = nullptr;
+  size_t mapping_bytes_ = 0;
+  bool huge_pages_ = false;
+  EventType* _buffer = nullptr;
+};
+
+}  // namespace disruptor
@@ -4,13 +4,30 @@
 //
 #pragma once
 
-#include <exception>
+#include <cstdint>
 
 namespace disruptor {
 
-class Eof : public std::exception {
- public:
-  const char* what() const noexcept override { return "eof"; }
+/**
+ *  Returned by next(), wait_for() and friends in place of a position.
+ *  Positions never go below Sequence::INIT_SEQUENCE, so a consumer can
+ *  simply stop once wait_for() returns less than it asked for.
+ *
+ *  @code
+ *  auto available_sequence = consumer->wait_for(next_sequence);
+ *  if (available_sequence < next_sequence) break;  // kEof, kHalted...
+ *  @endcode
+ */
+enum : int64_t {
+  /** try_next(): fewer slots are free than were asked for */
+  kInsufficientCapacity = -2,
+  /** the stream ended and everything published has been consumed */
+  kEof = -3,
+  /** the stream was halted, events not consumed yet are dropped */
+  kHalted = -4,
+  /** the consumer fell too far behind and its producer stopped waiting
+   *  for it, the slots it had yet to read may be overwritten */
+  kOverrun = -5,
 };
 
 }  // namespace disruptor
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <disruptor/barrier.h>
+#include <disruptor/eof.h>
 #include <disruptor/sequence.h>
+#include <disruptor/telemetry.h>
 
 namespace disruptor {
 
@@ -88,18 +90,49 @@ class EventCursor : public Sequence {
  public:
   /** this event processor will process every event
    *  upto, but not including s
+   *
+   *  @param max_lag - a producer evicts s once it falls more than max_lag
+   *  behind, see Barrier::evict_laggards()
    */
   template <typename T>
-  void follow(T&& s) {
-    barrier_.follow(std::forward<T>(s));
+  void follow(T&& s, int64_t max_lag = Barrier::kNoLagLimit) {
+    barrier_.follow(std::forward<T>(s), max_lag);
   }
 
+  /**
+   *  Stops following s, also while events flow.  A producer detaches a
+   *  consumer that is too slow or gone this way, anything following that
+   *  consumer has to be detached from it as well.
+   *
+   *  @return false if s was not followed
+   */
+  bool unfollow(const Sequence& s) { return barrier_.unfollow(s); }
+
   /** makes the event at p available to those following this cursor */
-  void publish(int64_t p) { store(p); }
+  void publish(int64_t p) {
+    telemetry_.add(Telemetry::kPublishes);
+    store(p);
+    notify();
+  }
+
+  /** @return the counters of this cursor, see DISRUPTOR_TELEMETRY */
+  TelemetrySnapshot telemetry() const { return telemetry_.snapshot(); }
 
  protected:
+  /** passes the end of the stream a barrier reported on to those
+   *  following this cursor */
+  int64_t forward_end(int64_t available) {
+    if (available == kEof) {
+      set_eof();
+    } else if (available == kHalted) {
+      halt();
+    }
+    return available;
+  }
+
   /** last know available, min(_limit_seq) */
   Barrier barrier_;
+  Telemetry telemetry_;
 };
 
 }  // namespace disruptor
@@ -0,0 +1,124 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <disruptor/exceptions.h>
+#include <disruptor/multi_producer_sequencer.h>
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace disruptor {
+
+/**
+ *  Events that own memory, strings or vectors, should be built once and
+ *  then reused in place, so that publishing never allocates.
+ *
+ *  The rings build every slot up front, from a factory if given one, e.g.
+ *  with reserved capacity.  A producer fills the slot it claimed with a
+ *  translator instead of assigning a whole new event, and the last
+ *  consumer may clear() the slot after use, which drops the contents but
+ *  keeps the capacity, see BatchOptions::clear_events.
+ *
+ *  @code
+ *  auto ring = std::make_shared<RingBuffer<Order, 1024>>([] {
+ *    Order order;
+ *    order.symbol.reserve(16);
+ *    return order;
+ *  });
+ *
+ *  publish_event(*ring, *producer,
+ *                [](Order& order, int64_t, const char* symbol, int qty) {
+ *                  order.symbol.assign(symbol);
+ *                  order.qty = qty;
+ *                },
+ *                "ES", 10);
+ *  @endcode
+ */
+
+namespace detail {
+
+template <typename T, typename = void>
+struct has_clear : std::false_type {};
+
+template <typename T>
+struct has_clear<T, decltype(std::declval<T&>().clear(), void())>
+    : std::true_type {};
+
+template <typename EventType>
+void clear_event(EventType& event, std::true_type) {
+  event.clear();
+}
+
+template <typename EventType>
+void clear_event(EventType&, std::false_type) {}
+
+template <typename Producer>
+void publish_claimed(Producer& producer, int64_t pos) {
+  producer.publish(pos);
+}
+
+inline void publish_claimed(MultiProducerSequencer& producer, int64_t pos) {
+  producer.publish_after(pos, pos - 1);
+}
+
+template <typename Ring, typename Producer, typename Translator,
+          typename... Args>
+void translate_and_publish(Ring& ring, Producer& producer, int64_t pos,
+                           Translator& translator, Args&&... args) {
+  DISRUPTOR_TRY {
+    translator(ring.at(pos), pos, std::forward<Args>(args)...);
+  } DISRUPTOR_CATCH_ALL {
+    // the slot is claimed, followers would wait for it forever
+    publish_claimed(producer, pos);
+    DISRUPTOR_RETHROW;
+  }
+  publish_claimed(producer, pos);
+}
+
+}  // namespace detail
+
+/** resets event for reuse with its clear(), if it has one */
+template <typename EventType>
+void clear_event(EventType& event) {
+  detail::clear_event(event, detail::has_clear<EventType>());
+}
+
+/**
+ *  Claims the next slot, fills it in place with
+ *  translator(event, pos, args...) and publishes it.  The slot is
+ *  published even if the translator throws.
+ *
+ *  @return the position published, or the status next() returned
+ */
+template <typename Ring, typename Producer, typename Translator,
+          typename... Args>
+int64_t publish_event(Ring& ring, Producer& producer, Translator&& translator,
+                      Args&&... args) {
+  auto pos = producer.next();
+  if (pos < 0) return pos;
+  detail::translate_and_publish(ring, producer, pos, translator,
+                                std::forward<Args>(args)...);
+  return pos;
+}
+
+/**
+ *  Like publish_event(), but never waits for the consumers.
+ *
+ *  @return the position published, or the status try_next() returned,
+ *  e.g. kInsufficientCapacity
+ */
+template <typename Ring, typename Producer, typename Translator,
+          typename... Args>
+int64_t try_publish_event(Ring& ring, Producer& producer,
+                          Translator&& translator, Args&&... args) {
+  auto pos = producer.try_next();
+  if (pos < 0) return pos;
+  detail::translate_and_publish(ring, producer, pos, translator,
+                                std::forward<Args>(args)...);
+  return pos;
+}
+
+}  // namespace disruptor
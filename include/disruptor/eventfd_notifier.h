@@ -0,0 +1,145 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#include <disruptor/exceptions.h>
+#include <disruptor/membarrier.h>
+#include <disruptor/sequence.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+namespace disruptor {
+
+/**
+ *  An eventfd a consumer group can wait on in epoll (or io_uring, poll...)
+ *  next to its sockets, instead of sleeping in a wait strategy.
+ *
+ *  Producers only write the eventfd while the group is parked, publishing
+ *  into a busy group costs the same single load as with any blocking
+ *  follower and no syscall.
+ *
+ *  @code
+ *  EventFdNotifier notifier;
+ *  notifier.attach(*producer);
+ *  epoll_ctl(epfd, EPOLL_CTL_ADD, notifier.fd(), &event);
+ *
+ *  while (true) {
+ *    auto available = consumer->try_wait_for(next_sequence);
+ *    if (available < next_sequence) {
+ *      notifier.park();
+ *      // re-check, the producer may have published before we parked
+ *      available = consumer->try_wait_for(next_sequence);
+ *      if (available < next_sequence) epoll_wait(epfd, events, n, -1);
+ *      notifier.unpark();
+ *      ... serve the sockets that are ready ...
+ *      continue;
+ *    }
+ *    ... process [next_sequence, available] ...
+ *  }
+ *  @endcode
+ */
+class EventFdNotifier {
+ public:
+  EventFdNotifier() : fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (fd_ < 0)
+      detail::throw_exception<std::system_error>(
+          errno, std::generic_category(), "eventfd");
+  }
+
+  ~EventFdNotifier() {
+    if (parked_.load(std::memory_order_relaxed)) unpark();
+    for (size_t i = 0; i < sequences_.size(); ++i) {
+      sequences_[i]->remove_listener(listeners_[i].get());
+    }
+    close(fd_);
+  }
+
+  EventFdNotifier(const EventFdNotifier&) = delete;
+  EventFdNotifier& operator=(const EventFdNotifier&) = delete;
+
+  /** readable once a cursor attached publishes while parked */
+  int fd() const { return fd_; }
+
+  /**
+   *  Has publishing on s signal fd() while parked, attach every cursor the
+   *  group follows.  s must outlive the notifier or be detached first, and
+   *  may not be process shared, e.g. a cursor of a SharedMemoryRing.  s
+   *  may be published to meanwhile, the next park() sees that publish or
+   *  fd() is signalled.
+   */
+  void attach(const Sequence& s) {
+    add_listener(s);
+    // publishers that did not see notify enabled published before this
+    detail::process_fence();
+  }
+
+  /** attaches every sequence of ss, with a single process fence */
+  void attach(const std::vector<const Sequence*>& ss) {
+    for (auto s : ss) add_listener(*s);
+    detail::process_fence();
+  }
+
+  /**
+   *  Stops publishing on s from signalling fd(), publishing on s no longer
+   *  has to notify once nothing else waits on it.
+   *
+   *  @return false if s was not attached
+   */
+  bool detach(const Sequence& s) {
+    auto itr = std::find(sequences_.begin(), sequences_.end(), &s);
+    if (itr == sequences_.end()) return false;
+
+    auto i = itr - sequences_.begin();
+    if (parked()) s.cancel_wait();
+    s.remove_listener(listeners_[i].get());
+    sequences_.erase(itr);
+    listeners_.erase(listeners_.begin() + i);
+    return true;
+  }
+
+  /** announces the group goes to sleep on fd(), check the queue once more
+   *  afterwards so no publish is missed */
+  void park() {
+    parked_.store(true, std::memory_order_relaxed);
+    for (auto s : sequences_) s->prepare_wait();
+  }
+
+  /** back to polling, consumes any pending signal */
+  void unpark() {
+    parked_.store(false, std::memory_order_relaxed);
+    for (auto s : sequences_) s->cancel_wait();
+    uint64_t count;
+    while (read(fd_, &count, sizeof(count)) > 0) {
+    }
+  }
+
+  bool parked() const { return parked_.load(std::memory_order_relaxed); }
+
+ private:
+  void add_listener(const Sequence& s) {
+    std::unique_ptr<detail::ParkedListener> listener(
+        new detail::ParkedListener(fd_, &parked_));
+    listeners_.reserve(listeners_.size() + 1);
+    sequences_.reserve(sequences_.size() + 1);
+    s.add_listener(listener.get());
+    listeners_.push_back(std::move(listener));
+    sequences_.push_back(&s);
+  }
+
+  int fd_;
+  std::atomic<bool> parked_{false};
+  std::vector<std::unique_ptr<detail::ParkedListener>> listeners_;
+  std::vector<const Sequence*> sequences_;
+};
+
+}  // namespace disruptor
@@ -0,0 +1,44 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+/**
+ *  Nothing on the publish / consume path throws, the end of a stream is
+ *  reported with the status codes in eof.h.  Errors in setting up rings
+ *  and sequencers do throw, and abort when built with -fno-exceptions.
+ */
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define DISRUPTOR_EXCEPTIONS 1
+#define DISRUPTOR_TRY try
+#define DISRUPTOR_CATCH_ALL catch (...)
+#define DISRUPTOR_RETHROW throw
+#else
+#define DISRUPTOR_EXCEPTIONS 0
+#define DISRUPTOR_TRY if (true)
+#define DISRUPTOR_CATCH_ALL else
+#define DISRUPTOR_RETHROW
+#endif
+
+namespace disruptor {
+namespace detail {
+
+/** throws E, or prints what it would have said and aborts */
+template <typename E, typename... Args>
+[[noreturn]] void throw_exception(Args&&... args) {
+#if DISRUPTOR_EXCEPTIONS
+  throw E(std::forward<Args>(args)...);
+#else
+  std::fprintf(stderr, "disruptor: %s\n",
+               E(std::forward<Args>(args)...).what());
+  std::abort();
+#endif
+}
+
+}  // namespace detail
+}  // namespace disruptor
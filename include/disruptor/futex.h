@@ -0,0 +1,43 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#if defined(__linux__)
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+
+namespace disruptor {
+namespace detail {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex words must be plain 32 bit integers");
+
+/** sleeps while *word == expected, may return spuriously.  Words in
+ *  memory shared with other processes must pass process_shared. */
+inline void futex_wait(const std::atomic<uint32_t>* word, uint32_t expected,
+                       bool process_shared = false) {
+  syscall(SYS_futex, reinterpret_cast<const uint32_t*>(word),
+          process_shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, expected, nullptr,
+          nullptr, 0);
+}
+
+/** wakes every thread sleeping in futex_wait() on word */
+inline void futex_wake_all(const std::atomic<uint32_t>* word,
+                           bool process_shared = false) {
+  syscall(SYS_futex, reinterpret_cast<const uint32_t*>(word),
+          process_shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, INT_MAX, nullptr,
+          nullptr, 0);
+}
+
+}  // namespace detail
+}  // namespace disruptor
+
+#endif
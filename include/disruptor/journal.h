@@ -0,0 +1,540 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <dirent.h>
+#include <disruptor/exceptions.h>
+#include <disruptor/sequence.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace disruptor {
+
+struct JournalOptions {
+  enum Sync {
+    /** write back is left to the kernel, survives a crash of the process
+     *  but not of the machine */
+    kNoSync,
+    /** starts write back of every batch with msync(MS_ASYNC) */
+    kAsync,
+    /** msync(MS_SYNC) every batch before it is published downstream */
+    kMsync,
+    /** fdatasync() every batch before it is published downstream */
+    kFdatasync,
+  };
+
+  /** size of a segment file, preallocated when the segment is created */
+  size_t segment_bytes = 64 * 1024 * 1024;
+  Sync sync = kNoSync;
+  /** touch every page of a new segment up front instead of on first
+   *  append */
+  bool prefault = true;
+};
+
+namespace detail {
+
+static constexpr uint64_t kJournalMagic = 0x4a524e4c44495352ULL;
+static constexpr uint32_t kJournalVersion = 1;
+
+/** the start of every segment file, records follow at sizeof() */
+struct alignas(64) JournalHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t event_size;
+  uint64_t record_bytes;
+  uint64_t segment_bytes;
+  int64_t first_index;
+};
+
+/** precedes every event, an index that does not follow on from the
+ *  previous record or a checksum mismatch marks the end of the journal */
+struct JournalRecord {
+  int64_t index;
+  uint64_t checksum;
+};
+
+inline uint64_t journal_checksum(const void* data, size_t bytes,
+                                 int64_t index) {
+  auto p = static_cast<const unsigned char*>(data);
+  uint64_t hash = 0xcbf29ce484222325ULL ^ static_cast<uint64_t>(index);
+  size_t i = 0;
+  for (; i + 8 <= bytes; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, p + i, 8);
+    hash = (hash ^ word) * 0x100000001b3ULL;
+    hash ^= hash >> 29;
+  }
+  for (; i < bytes; ++i) hash = (hash ^ p[i]) * 0x100000001b3ULL;
+  // a zeroed record never checks out
+  return hash | 1;
+}
+
+/** @return the segment files of a journal, ordered by their first index */
+inline std::vector<std::pair<int64_t, std::string>> journal_segments(
+    const std::string& directory) {
+  std::vector<std::pair<int64_t, std::string>> segments;
+  auto dir = opendir(directory.c_str());
+  if (dir == nullptr) {
+    if (errno == ENOENT) return segments;
+    detail::throw_exception<std::system_error>(errno, std::generic_category(),
+                                               directory);
+  }
+  while (auto entry = readdir(dir)) {
+    char* end = nullptr;
+    auto first_index = std::strtoll(entry->d_name, &end, 10);
+    if (end == entry->d_name || std::strcmp(end, ".journal") != 0) continue;
+    segments.emplace_back(first_index, directory + "/" + entry->d_name);
+  }
+  closedir(dir);
+  std::sort(segments.begin(), segments.end());
+  return segments;
+}
+
+inline std::string journal_segment_path(const std::string& directory,
+                                        int64_t first_index) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%020lld.journal",
+                static_cast<long long>(first_index));
+  return directory + "/" + name;
+}
+
+/** @return whether the segment file at path is too short to hold a
+ *  header, i.e. a crash came between creating and preallocating it */
+inline bool journal_segment_unstarted(const std::string& path) {
+  struct stat st {};
+  if (::stat(path.c_str(), &st) != 0)
+    detail::throw_exception<std::system_error>(
+        errno, std::generic_category(), path);
+  return static_cast<size_t>(st.st_size) < sizeof(JournalHeader);
+}
+
+/** a segment file mapped in whole */
+class JournalSegment {
+ public:
+  JournalSegment() = default;
+
+  JournalSegment(const std::string& path, int flags, size_t bytes,
+                 bool prefault)
+      : fd_(::open(path.c_str(), flags | O_CLOEXEC, 0644)) {
+    if (fd_ < 0)
+      detail::throw_exception<std::system_error>(
+          errno, std::generic_category(), path);
+
+    if (flags & O_CREAT) {
+      auto err = posix_fallocate(fd_, 0, static_cast<off_t>(bytes));
+      if (err != 0) {
+        close();
+        detail::throw_exception<std::system_error>(
+            err, std::generic_category(), "journal fallocate");
+      }
+    } else {
+      struct stat st {};
+      if (fstat(fd_, &st) != 0) {
+        auto err = errno;
+        close();
+        detail::throw_exception<std::system_error>(
+            err, std::generic_category(), "journal fstat");
+      }
+      bytes = static_cast<size_t>(st.st_size);
+    }
+
+    auto prot = (flags & O_ACCMODE) == O_RDONLY ? PROT_READ
+                                                : PROT_READ | PROT_WRITE;
+    auto map_flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (prefault) map_flags |= MAP_POPULATE;
+#endif
+    if (bytes >= sizeof(JournalHeader)) {
+      data_ =
+          static_cast<char*>(mmap(nullptr, bytes, prot, map_flags, fd_, 0));
+    }
+    if (bytes < sizeof(JournalHeader) || data_ == MAP_FAILED) {
+      auto err = bytes < sizeof(JournalHeader) ? EINVAL : errno;
+      data_ = nullptr;
+      close();
+      detail::throw_exception<std::system_error>(
+          err, std::generic_category(), "journal mmap");
+    }
+    bytes_ = bytes;
+  }
+
+  ~JournalSegment() { close(); }
+
+  JournalSegment(JournalSegment&& other) noexcept { swap(other); }
+  JournalSegment& operator=(JournalSegment&& other) noexcept {
+    JournalSegment(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  JournalHeader* header() const {
+    return reinterpret_cast<JournalHeader*>(data_);
+  }
+  char* data() const { return data_; }
+  size_t bytes() const { return bytes_; }
+  int fd() const { return fd_; }
+
+  /** @return how many records fit, given the header is valid */
+  int64_t capacity() const {
+    return static_cast<int64_t>((bytes_ - sizeof(JournalHeader)) /
+                                header()->record_bytes);
+  }
+
+  JournalRecord* record(int64_t i) const {
+    return reinterpret_cast<JournalRecord*>(
+        data_ + sizeof(JournalHeader) + i * header()->record_bytes);
+  }
+
+  /** @return whether record i holds index and checks out */
+  bool valid(int64_t i, int64_t index, size_t event_size) const {
+    auto r = record(i);
+    return r->index == index &&
+           r->checksum == journal_checksum(r + 1, event_size, index);
+  }
+
+ private:
+  void swap(JournalSegment& other) noexcept {
+    std::swap(fd_, other.fd_);
+    std::swap(data_, other.data_);
+    std::swap(bytes_, other.bytes_);
+  }
+
+  void close() {
+    if (data_ != nullptr) munmap(data_, bytes_);
+    if (fd_ >= 0) ::close(fd_);
+    data_ = nullptr;
+    fd_ = -1;
+  }
+
+  int fd_ = -1;
+  char* data_ = nullptr;
+  size_t bytes_ = 0;
+};
+
+}  // namespace detail
+
+/**
+ *  Appends events to a journal on disk: a directory of memory mapped
+ *  segment files, each named after the index of its first event.
+ *
+ *  Events are copied from the ring straight into the mapping, there is no
+ *  intermediate buffer and no write() per batch, only the sync policy
+ *  decides whether a batch costs a syscall.  Segments are preallocated
+ *  when created and a new one is started when the current one is full.
+ *
+ *  The writer is a handler for a BatchEventProcessor, so journaling runs
+ *  as an ordinary gating consumer, off the producer's publish path.
+ *  Every batch is synced at its end_of_batch, and with
+ *  BatchOptions::publish_interval before every publish within a batch
+ *  too, so consumers following the journaling consumer only see events
+ *  that are as durable as the sync policy makes them.
+ *
+ *  @code
+ *  auto journal = make_batch_event_processor(
+ *      ring, journal_consumer,
+ *      JournalWriter<Event>("/var/lib/feed", options));
+ *  journal_consumer->follow(producer);
+ *  downstream->follow(journal_consumer);
+ *  producer->follow(downstream);
+ *  std::thread journal_thread([&] { journal.run(); });
+ *  @endcode
+ *
+ *  Opening a directory that already holds a journal continues after its
+ *  last intact record, so a record torn by a crash is overwritten.  See
+ *  JournalReader to replay it.  Events are written as raw bytes and must
+ *  be trivially copyable.
+ */
+template <typename EventType>
+class JournalWriter {
+ public:
+  static_assert(std::is_trivially_copyable<EventType>::value,
+                "journaled events must be trivially copyable");
+
+  explicit JournalWriter(std::string directory, JournalOptions options = {})
+      : directory_(std::move(directory)), options_(options) {
+    if (::mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST)
+      detail::throw_exception<std::system_error>(
+          errno, std::generic_category(), directory_);
+    if (options_.segment_bytes < sizeof(detail::JournalHeader) + kRecordBytes)
+      detail::throw_exception<std::runtime_error>(
+          "journal segments must hold at least one event");
+
+    auto segments = detail::journal_segments(directory_);
+    if (segments.empty()) {
+      roll(0);
+    } else {
+      recover(segments.back().first, segments.back().second);
+    }
+  }
+
+  /** appends event, it is synced along with the rest of the batch */
+  void append(const EventType& event) {
+    if (slot_ == segment_.capacity()) {
+      sync();
+      roll(next_index_);
+    }
+    auto record = segment_.record(slot_);
+    std::memcpy(record + 1, &event, sizeof(EventType));
+    record->checksum =
+        detail::journal_checksum(record + 1, sizeof(EventType), next_index_);
+    record->index = next_index_;
+    ++slot_;
+    ++next_index_;
+  }
+
+  /** makes the events appended so far durable as the sync policy says */
+  void sync() {
+    if (slot_ == synced_slot_) return;
+    auto begin = reinterpret_cast<char*>(segment_.record(synced_slot_));
+    auto end = reinterpret_cast<char*>(segment_.record(slot_));
+
+    int result = 0;
+    switch (options_.sync) {
+      case JournalOptions::kNoSync:
+        break;
+      case JournalOptions::kAsync:
+        result = msync_range(begin, end, MS_ASYNC);
+        break;
+      case JournalOptions::kMsync:
+        result = msync_range(begin, end, MS_SYNC);
+        break;
+      case JournalOptions::kFdatasync:
+        result = fdatasync(segment_.fd());
+        break;
+    }
+    if (result != 0)
+      detail::throw_exception<std::system_error>(
+          errno, std::generic_category(), "journal sync");
+    // only now, a failed sync is retried with the next batch
+    synced_slot_ = slot_;
+  }
+
+  /** the BatchEventProcessor handler */
+  void on_event(const EventType& event, int64_t, bool end_of_batch) {
+    append(event);
+    if (end_of_batch) sync();
+  }
+
+  /** progress is published within a batch, see BatchOptions */
+  void before_publish(int64_t) { sync(); }
+
+  /** @return the index the next event appended gets, i.e. how many events
+   *  the journal holds */
+  int64_t next_index() const { return next_index_; }
+
+  /** @return the index after the last event synced */
+  int64_t synced_index() const {
+    return next_index_ - (slot_ - synced_slot_);
+  }
+
+ private:
+  static constexpr size_t kRecordBytes =
+      (sizeof(detail::JournalRecord) + sizeof(EventType) + 7) / 8 * 8;
+
+  /** starts a new segment whose first event is first_index */
+  void roll(int64_t first_index) {
+    auto path = detail::journal_segment_path(directory_, first_index);
+    segment_ = detail::JournalSegment(path, O_RDWR | O_CREAT | O_EXCL,
+                                      options_.segment_bytes,
+                                      options_.prefault);
+    start(first_index);
+  }
+
+  /** writes the header of the current segment, which holds no event yet */
+  void start(int64_t first_index) {
+    auto header = segment_.header();
+    header->magic = detail::kJournalMagic;
+    header->version = detail::kJournalVersion;
+    header->event_size = sizeof(EventType);
+    header->record_bytes = kRecordBytes;
+    header->segment_bytes = options_.segment_bytes;
+    header->first_index = first_index;
+    slot_ = 0;
+    synced_slot_ = 0;
+    next_index_ = first_index;
+
+    if (options_.sync >= JournalOptions::kMsync) {
+      // the header, and the new file in its directory
+      if (msync(segment_.data(), sizeof(detail::JournalHeader), MS_SYNC) != 0)
+        detail::throw_exception<std::system_error>(
+            errno, std::generic_category(), "journal sync");
+      sync_directory();
+    }
+  }
+
+  /** continues the segment at path after its last intact record */
+  void recover(int64_t first_index, const std::string& path) {
+    // a crash before the segment was preallocated, allocates it again
+    if (detail::journal_segment_unstarted(path)) {
+      segment_ = detail::JournalSegment(path, O_RDWR | O_CREAT,
+                                        options_.segment_bytes,
+                                        options_.prefault);
+      start(first_index);
+      return;
+    }
+    segment_ = detail::JournalSegment(path, O_RDWR, 0, options_.prefault);
+    auto header = segment_.header();
+    // a crash right after the segment was created
+    if (header->magic == 0) {
+      start(first_index);
+      return;
+    }
+    if (header->magic != detail::kJournalMagic ||
+        header->version != detail::kJournalVersion ||
+        header->first_index != first_index)
+      detail::throw_exception<std::runtime_error>("not a journal segment");
+    if (header->event_size != sizeof(EventType) ||
+        header->record_bytes != kRecordBytes)
+      detail::throw_exception<std::runtime_error>(
+          "journal holds events of another size");
+
+    slot_ = 0;
+    while (slot_ < segment_.capacity() &&
+           segment_.valid(slot_, first_index + slot_, sizeof(EventType))) {
+      ++slot_;
+    }
+    next_index_ = first_index + slot_;
+    // what follows may be left over from before a crash, and must not be
+    // mistaken for records once the gap before it is filled again
+    auto tail = reinterpret_cast<char*>(segment_.record(slot_));
+    std::memset(tail, 0, segment_.data() + segment_.bytes() - tail);
+    synced_slot_ = slot_;
+  }
+
+  static int msync_range(char* begin, char* end, int flags) {
+    static const auto page_size =
+        static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    auto page = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(begin) &
+                                        ~(page_size - 1));
+    return msync(page, static_cast<size_t>(end - page), flags);
+  }
+
+  void sync_directory() {
+    auto fd = ::open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0 || fsync(fd) != 0) {
+      auto err = errno;
+      if (fd >= 0) ::close(fd);
+      detail::throw_exception<std::system_error>(
+          err, std::generic_category(), directory_);
+    }
+    ::close(fd);
+  }
+
+  std::string directory_;
+  JournalOptions options_;
+  detail::JournalSegment segment_;
+  // records written to the current segment, and how many of them synced
+  int64_t slot_ = 0;
+  int64_t synced_slot_ = 0;
+  int64_t next_index_ = 0;
+};
+
+/**
+ *  Reads back a journal written by JournalWriter, e.g. to rebuild state
+ *  at startup.  Replay stops at the first record that is missing or torn.
+ *
+ *  @code
+ *  JournalReader<Event> journal("/var/lib/feed");
+ *  journal.replay_into(*ring, *producer);
+ *  @endcode
+ */
+template <typename EventType>
+class JournalReader {
+ public:
+  static_assert(std::is_trivially_copyable<EventType>::value,
+                "journaled events must be trivially copyable");
+
+  explicit JournalReader(std::string directory)
+      : directory_(std::move(directory)) {}
+
+  /**
+   *  Calls f(event, index) on every event in the journal from index from
+   *  on, in order.
+   *
+   *  @return the index after the last event replayed
+   */
+  template <typename F>
+  int64_t replay(F&& f, int64_t from = 0) const {
+    int64_t index = 0;
+    bool first = true;
+    auto segments = detail::journal_segments(directory_);
+    for (size_t s = 0; s < segments.size(); ++s) {
+      // skips segments that end before from
+      if (s + 1 < segments.size() && segments[s + 1].first <= from) continue;
+      if (!first && segments[s].first != index) break;
+
+      // the writer crashed before it started the last segment
+      auto last = s + 1 == segments.size();
+      if (last && detail::journal_segment_unstarted(segments[s].second))
+        return segments[s].first;
+      detail::JournalSegment segment(segments[s].second, O_RDONLY, 0, false);
+      auto header = segment.header();
+      if (last && header->magic == 0) return segments[s].first;
+      if (header->magic != detail::kJournalMagic ||
+          header->version != detail::kJournalVersion)
+        detail::throw_exception<std::runtime_error>("not a journal segment");
+      if (header->event_size != sizeof(EventType))
+        detail::throw_exception<std::runtime_error>(
+            "journal holds events of another size");
+
+      index = header->first_index;
+      first = false;
+      auto capacity = segment.capacity();
+      for (int64_t i = 0; i < capacity; ++i, ++index) {
+        if (!segment.valid(i, index, sizeof(EventType))) return index;
+        if (index < from) continue;
+        EventType event;
+        std::memcpy(&event, segment.record(i) + 1, sizeof(EventType));
+        f(static_cast<const EventType&>(event), index);
+      }
+    }
+    return index;
+  }
+
+  /**
+   *  Publishes every event in the journal into ring through producer,
+   *  which waits for its consumers like for any other event.
+   *
+   *  @return the last position published, or kHalted / kEof if the
+   *  producer ended first
+   */
+  template <typename Ring, typename Producer>
+  int64_t replay_into(Ring& ring, Producer& producer, int64_t from = 0) const {
+    int64_t last = producer.acquire();
+    replay(
+        [&](const EventType& event, int64_t) {
+          if (last < Sequence::INIT_SEQUENCE) return;
+          auto pos = producer.next();
+          if (pos < 0) {
+            last = pos;
+            return;
+          }
+          ring.at(pos) = event;
+          producer.publish(pos);
+          last = pos;
+        },
+        from);
+    return last;
+  }
+
+ private:
+  std::string directory_;
+};
+
+}  // namespace disruptor
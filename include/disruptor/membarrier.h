@@ -0,0 +1,63 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#include <atomic>
+
+#if defined(__linux__)
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace disruptor {
+namespace detail {
+
+/**
+ *  Asymmetric fences: a rare side issues process_fence(), which runs a
+ *  full fence on every thread of the process, so that the frequent side
+ *  gets away with a compiler barrier, e.g. a publisher checking whether
+ *  anyone needs to be woken up.
+ *
+ *  @return whether process_fence() is available, registers the process
+ *  on first use
+ */
+inline bool process_fence_available() {
+#if defined(__linux__) && defined(SYS_membarrier)
+  static const bool available = [] {
+    auto commands = syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0);
+    if (commands < 0 || !(commands & MEMBARRIER_CMD_PRIVATE_EXPEDITED))
+      return false;
+    return syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED,
+                   0) == 0;
+  }();
+  return available;
+#else
+  return false;
+#endif
+}
+
+/** a full fence on every running thread of the process, only with
+ *  process_fence_available() */
+inline void process_fence() {
+#if defined(__linux__) && defined(SYS_membarrier)
+  syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+#else
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/** the frequent side of process_fence(): only a compiler barrier where
+ *  process_fence() is available, a full fence otherwise */
+inline void light_fence() {
+  if (process_fence_available()) {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  } else {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+}
+
+}  // namespace detail
+}  // namespace disruptor
@@ -4,7 +4,14 @@
 //
 #pragma once
 
+#include <disruptor/availability_buffer.h>
 #include <disruptor/event_cursor.h>
+#include <disruptor/exceptions.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
 
 namespace disruptor {
 
@@ -14,73 +21,175 @@ namespace disruptor {
  *  in an atomic manner.
  *
  *  @code
- *  auto start = cur->next(slots);
+ *  auto end = cur->next(slots);
  *  ... do your writes...
- *  cur->publish_after( start + slots, start -1 );
+ *  cur->publish_after( end, end - slots );
  *  @endcode
  *
+ *  Every producer publishes its own slots independently of the others,
+ *  so a producer descheduled between next() and publish_after() only
+ *  holds back the followers, never the other producers.  The cursor
+ *  itself tracks the highest claimed slot, followers find out what
+ *  has been published through availability().
  */
 class MultiProducerSequencer : public EventCursor {
  private:
   using EventCursor::publish;
 
  public:
-  /** @param s - the size of the ringbuffer,
+  /** @param s - the size of the ringbuffer, must be a power of 2,
    *  required to do proper wrap detection
    **/
-  explicit MultiProducerSequencer(int64_t s) : size_(s) {
-    cached_min_sequence_ = Sequence::INIT_SEQUENCE;
+  explicit MultiProducerSequencer(int64_t s) : size_(s), available_(s) {
+    set_availability(&available_);
+    cached_min_sequence_.store(Sequence::INIT_SEQUENCE,
+                               std::memory_order_relaxed);
+    evict_at_.store(Sequence::INIT_SEQUENCE, std::memory_order_relaxed);
   }
 
   /**
    * When there are multiple writers they cannot both assume the right to
    * write, instead they must first next some slots in an atomic manner.
    *
-   *  After pos().acquire() == next( slots ) -1 the claimer
-   *  is free to call publish up to start + slots -1
+   *  The claimer is free to write up to and including the returned
+   *  slot and then publish the whole claim with publish_after
    *
-   *  @return the first slot the caller may write to.
+   *  @return the last slot the caller may write to, kEof once a producer
+   *  called set_eof(), kHalted once this cursor or a consumer it follows
+   *  was halted.
    */
   int64_t next(int64_t num_slots = 1) {
     if (num_slots < 1 || num_slots > size_) {
-      throw std::runtime_error("num must be > 0 and < size");
+      detail::throw_exception<std::runtime_error>(
+          "num must be > 0 and < size");
     }
-    auto next_sequence = claim_cursor_.increment_and_get(num_slots);
+    auto next_sequence = increment_and_get(num_slots);
     auto wrap_point = next_sequence - size_;
 
-    // make sure there is enough space to write
-    if (wrap_point >= cached_min_sequence_) {
-      int64_t min_sequence;
+    // make sure there is enough space to write, and that no consumer lags
+    // behind further than it may
+    int64_t min_sequence =
+        cached_min_sequence_.load(std::memory_order_relaxed);
+    if (wrap_point > min_sequence) {
+      evict_laggards(next_sequence);
+      Telemetry::Stall stall(&telemetry_, Telemetry::kClaimStalls);
       while (!eof() &&
-             wrap_point >= (min_sequence = barrier_.get_min(wrap_point))) {
+             wrap_point > (min_sequence = barrier_.get_min(wrap_point))) {
+        if (barrier_.halted()) return kHalted;
+        stall.idle(Telemetry::kYields);
         std::this_thread::yield();
       }
-      cached_min_sequence_ = min_sequence;
+      cached_min_sequence_.store(min_sequence, std::memory_order_relaxed);
+    } else if (next_sequence > evict_at_.load(std::memory_order_relaxed)) {
+      evict_laggards(next_sequence);
     }
 
-    if (eof()) throw Eof{};
+    if (eof()) return end_status();
+    telemetry_.add(Telemetry::kClaims, num_slots);
 
     return next_sequence;
   }
 
-  void publish_after(int64_t pos, int64_t after_pos) {
-    assert(pos > after_pos);
-
-    // Wait other producers
-    while (!eof() && after_pos > acquire()) {
-      // Busy waiting, if other producers claim the sequence, it should complete
-      // the release as soon as possible
+  /**
+   *  Like next(), but never waits for the consumers.
+   *
+   *  @return the last slot the caller may write to, kInsufficientCapacity
+   *  if fewer than num_slots slots are free, kEof or kHalted once ended or
+   *  a consumer it follows was halted
+   */
+  int64_t try_next(int64_t num_slots = 1) {
+    if (num_slots < 1 || num_slots > size_) {
+      detail::throw_exception<std::runtime_error>(
+          "num must be > 0 and < size");
     }
 
-    if (eof()) throw Eof{};
+    int64_t current;
+    int64_t next_sequence;
+    do {
+      if (eof()) return end_status();
+      current = acquire();
+      next_sequence = current + num_slots;
+      auto wrap_point = next_sequence - size_;
+      if (wrap_point > cached_min_sequence_.load(std::memory_order_relaxed)) {
+        evict_laggards(next_sequence);
+        auto min_sequence = barrier_.get_min(wrap_point);
+        if (wrap_point > min_sequence) {
+          if (barrier_.halted()) return kHalted;
+          telemetry_.add(Telemetry::kClaimFailures);
+          return kInsufficientCapacity;
+        }
+        cached_min_sequence_.store(min_sequence, std::memory_order_relaxed);
+      } else if (next_sequence > evict_at_.load(std::memory_order_relaxed)) {
+        evict_laggards(next_sequence);
+      }
+    } while (!compare_and_set(current, next_sequence));
+
+    telemetry_.add(Telemetry::kClaims, num_slots);
+    return next_sequence;
+  }
+
+  /** @return how many slots can be claimed without waiting */
+  int64_t remaining_capacity() {
+    auto claimed = acquire();
+    return size_ - (claimed - gating_min(claimed));
+  }
+
+  /** @return how many claimed events the slowest consumer has yet to
+   *  process */
+  int64_t consumer_lag() {
+    auto claimed = acquire();
+    return claimed - gating_min(claimed);
+  }
 
-    publish(pos);
+  /** @return the counters of this cursor, with the consumer_lag() as
+   *  occupancy */
+  TelemetrySnapshot telemetry() {
+    auto snapshot = EventCursor::telemetry();
+    snapshot.occupancy = consumer_lag();
+    return snapshot;
+  }
+
+  /** places the per slot availability words on node as well, see
+   *  make_shared_on_numa_node() */
+  void bind_to_numa_node(int node) { available_.bind_to_numa_node(node); }
+
+  /**
+   *  makes the claimed slots (after_pos, pos] available to followers
+   *
+   *  @return false, without publishing, once the stream ended
+   */
+  bool publish_after(int64_t pos, int64_t after_pos) {
+    assert(pos > after_pos);
+
+    if (eof()) return false;
+
+    telemetry_.add(Telemetry::kPublishes);
+    available_.set_available(after_pos + 1, pos);
+    notify();
+    return true;
   }
 
  private:
+  int64_t end_status() const { return halted() ? kHalted : kEof; }
+
+  void evict_laggards(int64_t pos) {
+    evict_at_.store(barrier_.evict_laggards(pos), std::memory_order_relaxed);
+  }
+
+  int64_t gating_min(int64_t pos) {
+    auto min_sequence =
+        barrier_.get_min(std::numeric_limits<int64_t>::max());
+    return std::min(min_sequence, pos);
+  }
+
   const int64_t size_;
-  Sequence claim_cursor_;
-  int64_t cached_min_sequence_;
+  AvailabilityBuffer available_;
+  // Producers CAS the cursor on every next(), keep the cached gating
+  // minimum on a line of its own.  Every producer reads and writes both,
+  // relaxed: a stale value only costs another look at the barrier.
+  alignas(kCacheLineSize) std::atomic<int64_t> cached_min_sequence_;
+  // the claim that is due a check for consumers lagging too far behind
+  std::atomic<int64_t> evict_at_;
 };
 
 }  // namespace disruptor
@@ -0,0 +1,33 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace disruptor {
+namespace detail {
+
+/**
+ *  Sleeping waiters park on a mutex / condition variable pair picked by
+ *  the address they wait on, so a sequence does not have to carry its own.
+ *  Unrelated sequences may hash to the same bucket, waiters must re-check
+ *  their condition after every wake up.
+ */
+struct ParkingBucket {
+  std::mutex mutex;
+  std::condition_variable cond;
+};
+
+inline ParkingBucket& parking_bucket(const void* addr) {
+  static constexpr uintptr_t kBuckets = 64;
+  static ParkingBucket buckets[kBuckets];
+  auto hash = reinterpret_cast<uintptr_t>(addr);
+  return buckets[(hash ^ (hash >> 12)) / 64 % kBuckets];
+}
+
+}  // namespace detail
+}  // namespace disruptor
@@ -0,0 +1,217 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <disruptor/exceptions.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace disruptor {
+
+/**
+ *  Optional NUMA placement of rings, cursors and threads.
+ *
+ *  A publish writes the ring slot and the producer cursor, and every
+ *  follower reads both; when they live on another socket than the threads
+ *  touching them every publish crosses the interconnect.  Everything here
+ *  talks to the kernel directly, so no libnuma is needed.  Elsewhere than
+ *  on Linux binding and pinning are no-ops and there is a single node.
+ *
+ *  @code
+ *  RingBufferOptions options;
+ *  options.numa_node = node;
+ *  auto ring = std::make_shared<DynamicRingBuffer<Event>>(size, options);
+ *  auto producer = make_shared_on_numa_node<SingleProducerSequencer>(
+ *      node, ring->size());
+ *  ...
+ *  pin_current_thread_to_numa_node(node);
+ *  @endcode
+ */
+
+/** @return the number of NUMA nodes, 1 on machines without NUMA support */
+inline int numa_node_count() {
+  int count = 0;
+  while (std::ifstream("/sys/devices/system/node/node" +
+                       std::to_string(count) + "/cpulist")) {
+    ++count;
+  }
+  return count > 0 ? count : 1;
+}
+
+/** @return the cpus belonging to node */
+inline std::vector<int> numa_node_cpus(int node) {
+  std::vector<int> cpus;
+  std::ifstream cpulist("/sys/devices/system/node/node" +
+                        std::to_string(node) + "/cpulist");
+  if (!cpulist) {
+    if (node != 0) return cpus;
+    // no NUMA support, every cpu is on node 0
+    for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu)
+      cpus.push_back(static_cast<int>(cpu));
+    return cpus;
+  }
+
+  // a list of ranges, e.g. "0-7,16-23"
+  std::string range;
+  while (std::getline(cpulist, range, ',')) {
+    int first = 0;
+    int last = 0;
+    char dash = 0;
+    std::istringstream in(range);
+    if (!(in >> first)) continue;
+    last = (in >> dash >> last) ? last : first;
+    for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+/**
+ *  Binds the pages in [addr, addr + bytes) to node, moving pages already
+ *  faulted in.  addr must be page aligned.
+ */
+inline void bind_to_numa_node(void* addr, size_t bytes, int node) {
+  static constexpr size_t kMaskBits = 8 * sizeof(unsigned long);
+  if (node < 0 || static_cast<size_t>(node) >= 16 * kMaskBits)
+    detail::throw_exception<std::runtime_error>("numa node out of range");
+
+#if defined(__linux__)
+  unsigned long node_mask[16] = {};
+  node_mask[node / kMaskBits] = 1UL << (node % kMaskBits);
+  if (syscall(SYS_mbind, addr, bytes, MPOL_BIND, node_mask, 16 * kMaskBits,
+              MPOL_MF_MOVE) != 0) {
+    detail::throw_exception<std::system_error>(
+        errno, std::generic_category(), "mbind");
+  }
+#else
+  (void)addr;
+  (void)bytes;
+#endif
+}
+
+namespace detail {
+
+/** @return bytes rounded up to whole pages */
+inline size_t page_round_up(size_t bytes) {
+  auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return (bytes + page_size - 1) / page_size * page_size;
+}
+
+/** maps bytes, a multiple of the page size, of memory bound to node */
+inline void* map_on_numa_node(size_t bytes, int node) {
+  void* addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED) {
+    detail::throw_exception<std::system_error>(
+        errno, std::generic_category(), "mmap");
+  }
+  DISRUPTOR_TRY { bind_to_numa_node(addr, bytes, node); }
+  DISRUPTOR_CATCH_ALL {
+    munmap(addr, bytes);
+    DISRUPTOR_RETHROW;
+  }
+  return addr;
+}
+
+template <typename T, typename = void>
+struct has_numa_binding : std::false_type {};
+
+template <typename T>
+struct has_numa_binding<
+    T, decltype(std::declval<T&>().bind_to_numa_node(0), void())>
+    : std::true_type {};
+
+template <typename T>
+void bind_members_to_numa_node(T& object, int node, std::true_type) {
+  object.bind_to_numa_node(node);
+}
+
+template <typename T>
+void bind_members_to_numa_node(T&, int, std::false_type) {}
+
+}  // namespace detail
+
+/**
+ *  Constructs a T (e.g. a sequencer, whose cursor is then placed as well)
+ *  in pages of its own bound to node.  A T keeping hot state on the heap
+ *  moves it to node in a bind_to_numa_node(node) member, which is called
+ *  right after construction, e.g. the AvailabilityBuffer of a
+ *  MultiProducerSequencer.
+ */
+template <typename T, typename... Args>
+std::shared_ptr<T> make_shared_on_numa_node(int node, Args&&... args) {
+  auto bytes = detail::page_round_up(sizeof(T));
+  void* addr = detail::map_on_numa_node(bytes, node);
+
+  T* object = nullptr;
+  DISRUPTOR_TRY {
+    object = new (addr) T(std::forward<Args>(args)...);
+    detail::bind_members_to_numa_node(*object, node,
+                                      detail::has_numa_binding<T>());
+  } DISRUPTOR_CATCH_ALL {
+    if (object != nullptr) object->~T();
+    munmap(addr, bytes);
+    DISRUPTOR_RETHROW;
+  }
+  return std::shared_ptr<T>(object, [bytes](T* p) {
+    p->~T();
+    munmap(p, bytes);
+  });
+}
+
+namespace detail {
+
+inline void set_affinity(pthread_t thread, const std::vector<int>& cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto cpu : cpus) CPU_SET(cpu, &set);
+  auto err = pthread_setaffinity_np(thread, sizeof(set), &set);
+  if (err != 0) {
+    detail::throw_exception<std::system_error>(
+        err, std::generic_category(), "set affinity");
+  }
+#else
+  (void)thread;
+  (void)cpus;
+#endif
+}
+
+}  // namespace detail
+
+/** restricts thread to a single cpu */
+inline void pin_thread_to_cpu(std::thread& thread, int cpu) {
+  detail::set_affinity(thread.native_handle(), {cpu});
+}
+
+/** restricts the calling thread to a single cpu */
+inline void pin_current_thread_to_cpu(int cpu) {
+  detail::set_affinity(pthread_self(), {cpu});
+}
+
+/** restricts the calling thread to the cpus of node */
+inline void pin_current_thread_to_numa_node(int node) {
+  detail::set_affinity(pthread_self(), numa_node_cpus(node));
+}
+
+}  // namespace disruptor
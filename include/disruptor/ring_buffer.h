@@ -3,6 +3,8 @@
 // Copyright (c) 2021 shawnfeng. All rights reserved.
 //
 #pragma once
+#include <disruptor/exceptions.h>
+#include <disruptor/span.h>
 #include <unistd.h>
 
 #include <atomic>
@@ -10,6 +12,8 @@
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <new>
+#include <type_traits>
 #include <vector>
 
 namespace disruptor {
@@ -26,6 +30,26 @@ class RingBuffer {
   static_assert(((Size != 0) && ((Size & (~Size + 1)) == Size)),
                 "Ring buffer's must be a power of 2");
 
+  /** value initializes every slot */
+  RingBuffer() {
+    construct([](void* slot) { new (slot) EventType(); });
+  }
+
+  /** builds every slot in place from factory() once, e.g. with reserved
+   *  capacity, see publish_event().  EventType need not be default
+   *  constructible. */
+  template <typename Factory,
+            typename = typename std::enable_if<!std::is_same<
+                typename std::decay<Factory>::type, RingBuffer>::value>::type>
+  explicit RingBuffer(Factory&& factory) {
+    construct([&](void* slot) { new (slot) EventType(factory()); });
+  }
+
+  ~RingBuffer() { destroy(Size); }
+
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
   /** @return a read-only reference to the event at pos */
   const EventType& at(int64_t pos) const { return _buffer[pos & (Size - 1)]; }
   const EventType& operator[](int64_t pos) const {
@@ -36,16 +60,50 @@ class RingBuffer {
   EventType& at(int64_t pos) { return _buffer[pos & (Size - 1)]; }
   EventType& operator[](int64_t pos) { return _buffer[pos & (Size - 1)]; }
 
-  /** useful to check for contiguous ranges when EventType is
-   *  POD and memcpy can be used.  OR if the buffer is being used
-   *  by a socket dumping raw bytes in.  In which case memcpy
-   *  would have to use to ranges instead of 1.
-   */
   int64_t index(int64_t pos) const { return pos & (Size - 1); }
   int64_t size() const { return Size; }
 
+  /** the events [pos, pos + count) as at most two contiguous ranges,
+   *  useful when EventType is POD and memcpy can be used.  OR if the
+   *  buffer is being used by a socket dumping raw bytes in.
+   *
+   *  @code
+   *  auto end = producer->next(n);
+   *  auto spans = ring->spans(end - n + 1, n);
+   *  memcpy(spans.first.data, src, spans.first.bytes());
+   *  memcpy(spans.second.data, src + spans.first.size, spans.second.bytes());
+   *  producer->publish(end);
+   *  @endcode
+   */
+  SpanPair<EventType> spans(int64_t pos, int64_t count) {
+    return make_span_pair(_buffer, Size, pos, count);
+  }
+  SpanPair<const EventType> spans(int64_t pos, int64_t count) const {
+    return make_span_pair<const EventType>(_buffer, Size, pos, count);
+  }
+
  private:
-  EventType _buffer[Size];
+  template <typename Construct>
+  void construct(Construct&& construct_at) {
+    uint64_t constructed = 0;
+    DISRUPTOR_TRY {
+      for (; constructed < Size; ++constructed) {
+        construct_at(&_buffer[constructed]);
+      }
+    } DISRUPTOR_CATCH_ALL {
+      destroy(constructed);
+      DISRUPTOR_RETHROW;
+    }
+  }
+
+  void destroy(uint64_t constructed) {
+    for (uint64_t i = 0; i < constructed; ++i) _buffer[i].~EventType();
+  }
+
+  // the slots are constructed and destroyed by hand
+  union {
+    EventType _buffer[Size];
+  };
 };
 
 }  // namespace disruptor
\ No newline at end of file
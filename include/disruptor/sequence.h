@@ -3,31 +3,95 @@
 // Copyright (c) 2021 shawnfeng. All rights reserved.
 //
 #pragma once
+#include <disruptor/exceptions.h>
+#include <disruptor/futex.h>
+#include <disruptor/membarrier.h>
+#include <disruptor/parking_lot.h>
 #include <unistd.h>
 
 #include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
+/**
+ *  Destructive interference size, i.e. the distance two independently written
+ *  fields must be apart to never share a cache line. 64 fits x86 and most
+ *  arm64 cores, use 128 where adjacent lines are prefetched in pairs.
+ */
+#ifndef DISRUPTOR_CACHE_LINE_SIZE
+#define DISRUPTOR_CACHE_LINE_SIZE 64
+#endif
+
 namespace disruptor {
 
+class AvailabilityBuffer;
+
+namespace detail {
+
+/** a file descriptor to signal while its owner is parked, see
+ *  EventFdNotifier */
+struct ParkedListener {
+  ParkedListener(int f, const std::atomic<bool>* p) : fd(f), parked(p) {}
+
+  const int fd;
+  const std::atomic<bool>* const parked;
+  // the list is linked through the listeners, see Sequence::add_listener()
+  mutable std::atomic<const ParkedListener*> next{nullptr};
+};
+
+}  // namespace detail
+
+static constexpr size_t kCacheLineSize = DISRUPTOR_CACHE_LINE_SIZE;
+
+static_assert((kCacheLineSize & (kCacheLineSize - 1)) == 0,
+              "Cache line size must be a power of 2");
+
 /**
  *  A sequence number must be padded to prevent false sharing and
  *  access to the sequence number must be protected by memory barriers.
  *
- *  In addition to tracking the sequence number, additional state associated
- *  with the sequence number is also made available.  No false sharing
- *  should occur because all 'state' is only written by one thread. This
- *  extra state includes whether or not this sequence number is 'EOF' and
- *  whether or not any alerts have been published.
+ *  The sequence number is the hot field, it is written on every publish
+ *  and polled by every follower, so it owns a whole cache line.  The
+ *  additional state associated with the sequence number (whether the
+ *  stream ended with set_eof() or was stopped with halt(), whether a
+ *  consumer was evicted by its producer) is cold and lives on a second
+ *  line.  Anything declared after a Sequence, e.g. the members of a
+ *  derived cursor, starts on a fresh line.
+ *
+ *  A sequence claimed by several producers publishes through an
+ *  AvailabilityBuffer, its value is then only an upper bound and followers
+ *  must check availability() for the highest published position.
+ *
+ *  Followers that would rather sleep than poll can register as waiters, see
+ *  BlockingWaitStrategy.  The writer only pays for waking them up once some
+ *  follower has asked for it with enable_notify(), and only makes the wake
+ *  up syscall while a waiter is registered.  On Linux waiters sleep on a
+ *  futex on the epoch word next to the waiter count, elsewhere they park on
+ *  a shared condition variable.
+ *
+ *  Followers sitting in epoll rather than on the futex add a listener, its
+ *  eventfd is written by notify() while the listener is parked.  Listeners
+ *  are process local and can not be added to a process shared sequence.
+ *
+ *  A sequence placed in memory mapped by several processes must be
+ *  constructed process_shared, so that waiters are woken across process
+ *  boundaries (Linux only).
  */
-class Sequence {
+class alignas(kCacheLineSize) Sequence {
  public:
-  int64_t INIT_SEQUENCE = -1;
-  Sequence() : _sequence(INIT_SEQUENCE), _alert(false) {}
+  static constexpr int64_t INIT_SEQUENCE = -1;
+  Sequence() : Sequence(false) {}
+  explicit Sequence(bool process_shared)
+      : _sequence(INIT_SEQUENCE),
+        _alert(kNoAlert),
+        process_shared_(process_shared) {}
 
   int64_t acquire() const { return _sequence.load(std::memory_order_acquire); }
   void store(int64_t value) {
@@ -38,13 +102,215 @@ class Sequence {
     return _sequence.fetch_add(inc, std::memory_order_release) + inc;
   }
 
-  /** when the cursor hits the end of a stream, it can set the eof flag */
-  void set_eof() { _alert = true; }
-  bool eof() const { return _alert; }
+  /** sets the sequence to value if it still is expected */
+  bool compare_and_set(int64_t expected, int64_t value) {
+    return _sequence.compare_exchange_strong(expected, value,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed);
+  }
+
+  /** when the cursor hits the end of a stream, it can set the eof flag,
+   *  followers still consume everything published before it */
+  void set_eof() { raise_alert(kEofAlert); }
+
+  /** stops followers right away, whatever they have not consumed yet */
+  void halt() { raise_alert(kHaltAlert); }
+
+  /** @return whether the stream ended, by set_eof() or halt() */
+  bool eof() const {
+    return _alert.load(std::memory_order_acquire) != kNoAlert;
+  }
+  bool halted() const {
+    return _alert.load(std::memory_order_acquire) == kHaltAlert;
+  }
+
+  /** set by a producer that evicted this consumer for lagging too far
+   *  behind, see Barrier::follow() */
+  void mark_overrun() const {
+    overrun_.store(true, std::memory_order_release);
+  }
+
+  /**
+   *  @return whether a producer stopped waiting for this consumer.  Checked
+   *  after reading events, a false also means that what was read had not
+   *  been overwritten yet.
+   */
+  bool overrun() const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return overrun_.load(std::memory_order_relaxed);
+  }
+  void clear_overrun() { overrun_.store(false, std::memory_order_relaxed); }
+
+  /** @return the published slots when several producers share this cursor */
+  const AvailabilityBuffer* availability() const { return availability_; }
+
+  /** a follower is going to block on this sequence, writers must notify()
+   *  until every enable_notify() is undone with disable_notify().  On a
+   *  cursor that is being published to already the follower issues a
+   *  detail::process_fence() before it relies on being woken up. */
+  void enable_notify() const {
+    notify_users_.fetch_add(1, std::memory_order_release);
+  }
+  void disable_notify() const {
+    notify_users_.fetch_sub(1, std::memory_order_release);
+  }
+  bool notify_enabled() const {
+    return notify_users_.load(std::memory_order_relaxed) != 0;
+  }
+
+  bool process_shared() const { return process_shared_; }
+
+  /**
+   *  Registers the caller as a waiter.  The caller must re-check its
+   *  condition afterwards and then either wait() or cancel_wait().
+   *
+   *  @return the ticket to pass to wait()
+   */
+  uint32_t prepare_wait() const {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return epoch_.load(std::memory_order_acquire);
+  }
+
+  /** sleeps until a notify() issued after prepare_wait() returned ticket */
+  void wait(uint32_t ticket) const {
+#if defined(__linux__)
+    // notify() bumps the epoch before it looks for sleepers, so either it
+    // sees us or the futex sees the new epoch
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    while (epoch_.load(std::memory_order_acquire) == ticket) {
+      detail::futex_wait(&epoch_, ticket, process_shared_);
+    }
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+#else
+    auto& bucket = detail::parking_bucket(this);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+    while (epoch_.load(std::memory_order_acquire) == ticket) {
+      bucket.cond.wait(lock);
+    }
+#endif
+  }
+
+  void cancel_wait() const { waiters_.fetch_sub(1, std::memory_order_relaxed); }
+
+  /**
+   *  Has notify() write to listener->fd while *listener->parked, the owner
+   *  registers as a waiter with prepare_wait() before parking.  The
+   *  listener must stay alive until remove_listener().
+   */
+  void add_listener(const detail::ParkedListener* listener) const {
+    if (process_shared_)
+      detail::throw_exception<std::logic_error>(
+          "listeners can not be added to a process shared sequence");
+
+    std::lock_guard<std::mutex> lock(detail::parking_bucket(this).mutex);
+    listener->next.store(listeners_.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    listeners_.store(listener, std::memory_order_release);
+    enable_notify();
+  }
+
+  /** unlinks listener, which may be freed once this returns, i.e. once no
+   *  notify() is walking the listeners any more */
+  void remove_listener(const detail::ParkedListener* listener) const {
+    {
+      std::lock_guard<std::mutex> lock(detail::parking_bucket(this).mutex);
+      auto link = &listeners_;
+      auto itr = link->load(std::memory_order_relaxed);
+      while (itr != nullptr && itr != listener) {
+        link = &itr->next;
+        itr = link->load(std::memory_order_relaxed);
+      }
+      if (itr == nullptr) return;
+      link->store(listener->next.load(std::memory_order_relaxed),
+                  std::memory_order_release);
+      disable_notify();
+    }
+
+    // pairs with the fence in notify(): either it sees the listener
+    // unlinked or we see it walking the list
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (listener_readers_.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  /** wakes every registered waiter, a no-op unless notify is enabled */
+  void notify() const {
+    // the publish stays ahead of the check, so a follower enabling notify
+    // and then issuing a detail::process_fence() sees one or the other.
+    // Publishers in other processes are out of reach of that fence, a
+    // shared sequence always checks for waiters.
+    if (!process_shared_) {
+      detail::light_fence();
+      if (!notify_enabled()) return;
+    }
+
+    // pairs with the fence in prepare_wait(): either the waiter sees the
+    // new value or we see the waiter
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_acquire) == 0) return;
+
+#if defined(__linux__)
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) > 0)
+      detail::futex_wake_all(&epoch_, process_shared_);
+#else
+    auto& bucket = detail::parking_bucket(this);
+    {
+      std::lock_guard<std::mutex> lock(bucket.mutex);
+      epoch_.fetch_add(1, std::memory_order_release);
+    }
+    bucket.cond.notify_all();
+#endif
+
+    if (listeners_.load(std::memory_order_relaxed) == nullptr) return;
+    listener_readers_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (auto listener = listeners_.load(std::memory_order_acquire);
+         listener != nullptr;
+         listener = listener->next.load(std::memory_order_acquire)) {
+      if (!listener->parked->load(std::memory_order_relaxed)) continue;
+      uint64_t one = 1;
+      auto written = write(listener->fd, &one, sizeof(one));
+      (void)written;  // a full eventfd is still readable
+    }
+    listener_readers_.fetch_sub(1, std::memory_order_release);
+  }
+
+ protected:
+  void set_availability(const AvailabilityBuffer* availability) {
+    availability_ = availability;
+  }
 
  private:
-  std::atomic<int64_t> _sequence;
-  volatile bool _alert;
+  enum : uint8_t { kNoAlert, kEofAlert, kHaltAlert };
+
+  /** escalates the alert, a halt is never turned back into an eof */
+  void raise_alert(uint8_t alert) {
+    auto current = _alert.load(std::memory_order_relaxed);
+    while (current < alert &&
+           !_alert.compare_exchange_weak(current, alert,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+    }
+    notify();
+  }
+
+  alignas(kCacheLineSize) std::atomic<int64_t> _sequence;
+  alignas(kCacheLineSize) std::atomic<uint8_t> _alert;
+  const bool process_shared_;
+  mutable std::atomic<uint32_t> notify_users_{0};
+  mutable std::atomic<bool> overrun_{false};
+  mutable std::atomic<uint32_t> waiters_{0};
+  mutable std::atomic<uint32_t> epoch_{0};
+  mutable std::atomic<uint32_t> sleepers_{0};
+  const AvailabilityBuffer* availability_ = nullptr;
+  mutable std::atomic<const detail::ParkedListener*> listeners_{nullptr};
+  mutable std::atomic<uint32_t> listener_readers_{0};
 };
 
+static_assert(sizeof(Sequence) == 2 * kCacheLineSize,
+              "Sequence must span exactly one hot and one cold cache line");
+
 }  // namespace disruptor
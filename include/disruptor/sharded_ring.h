@@ -0,0 +1,195 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <disruptor/consumer_sequencer.h>
+#include <disruptor/dynamic_ring_buffer.h>
+#include <disruptor/eof.h>
+#include <disruptor/event_translator.h>
+#include <disruptor/exceptions.h>
+#include <disruptor/multi_producer_sequencer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace disruptor {
+
+/**
+ *  K rings, each with a producer and a consumer cursor of its own, behind
+ *  one front end.
+ *
+ *  All producers of a MultiProducerSequencer claim on the same cursor, so
+ *  adding producers stops adding throughput once that line is saturated.
+ *  Spreading them over shards spreads the claims: events are routed by
+ *  the hash of a key, which keeps the order of every key, or by producer
+ *  affinity, which keeps the order of every producer.
+ *
+ *  @code
+ *  ShardedRing<Order> orders(8, 1024);
+ *
+ *  // any producer thread
+ *  orders.publish_event(orders.shard_for(order.account), translate, order);
+ *
+ *  // the consumer thread
+ *  while (true) {
+ *    auto processed = orders.poll([](const Order& order, size_t shard,
+ *                                    int64_t pos) { ... });
+ *    if (processed < 0) break;  // kEof or kHalted
+ *    if (processed == 0) std::this_thread::yield();
+ *  }
+ *  @endcode
+ *
+ *  The shards can use a SingleProducerSequencer when every producer thread
+ *  owns a shard, taken with claim_shard() and only ever published to by
+ *  that thread.  More consumers may follow the cursors of a shard, see
+ *  shard().
+ */
+template <typename EventType, typename Producer = MultiProducerSequencer,
+          typename Consumer = ConsumerSequencer>
+class ShardedRing {
+ public:
+  typedef EventType event_type;
+
+  struct Shard {
+    std::shared_ptr<DynamicRingBuffer<EventType>> ring;
+    std::shared_ptr<Producer> producer;
+    std::shared_ptr<Consumer> consumer;
+  };
+
+  /** @param shard_size - the size of every ring, must be a power of 2 */
+  ShardedRing(size_t shards, int64_t shard_size,
+              RingBufferOptions options = {})
+      : claimed_(new std::atomic<bool>[shards]), next_sequences_(shards, 0) {
+    if (shards < 1)
+      detail::throw_exception<std::runtime_error>("shards must be > 0");
+    for (size_t s = 0; s < shards; ++s) {
+      Shard shard;
+      shard.ring = std::make_shared<DynamicRingBuffer<EventType>>(shard_size,
+                                                                  options);
+      shard.producer = std::make_shared<Producer>(shard_size);
+      shard.consumer = std::make_shared<Consumer>();
+      shard.consumer->follow(shard.producer);
+      shard.producer->follow(shard.consumer);
+      shards_.push_back(std::move(shard));
+      claimed_[s].store(false, std::memory_order_relaxed);
+    }
+  }
+
+  ShardedRing(const ShardedRing&) = delete;
+  ShardedRing& operator=(const ShardedRing&) = delete;
+
+  size_t shard_count() const { return shards_.size(); }
+  const Shard& shard(size_t s) const { return shards_[s]; }
+
+  /** @return the shard every event of key goes to */
+  template <typename Key>
+  size_t shard_for(const Key& key) const {
+    // std::hash of an integer is the integer itself, spread it out
+    auto hash = static_cast<uint64_t>(std::hash<Key>()(key));
+    hash *= 0x9e3779b97f4a7c15ULL;
+    return static_cast<size_t>((hash >> 32) % shards_.size());
+  }
+
+  /**
+   *  Takes a shard no other producer owns, for the caller to publish to
+   *  alone until it gives it back with release_shard().
+   *
+   *  @throw std::runtime_error if every shard is owned already
+   */
+  size_t claim_shard() {
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      if (!claimed_[s].load(std::memory_order_relaxed) &&
+          !claimed_[s].exchange(true, std::memory_order_acquire))
+        return s;
+    }
+    detail::throw_exception<std::runtime_error>("every shard is claimed");
+  }
+
+  /** gives back a shard taken with claim_shard(), once its owner has
+   *  published its last event */
+  void release_shard(size_t s) {
+    claimed_[s].store(false, std::memory_order_release);
+  }
+
+  /**
+   *  Publishes an event to shard s, filled in place with
+   *  translator(event, pos, args...), see disruptor::publish_event().
+   *
+   *  @return the position in the shard, or the status next() returned
+   */
+  template <typename Translator, typename... Args>
+  int64_t publish_event(size_t s, Translator&& translator, Args&&... args) {
+    auto& shard = shards_[s];
+    return disruptor::publish_event(*shard.ring, *shard.producer,
+                                    std::forward<Translator>(translator),
+                                    std::forward<Args>(args)...);
+  }
+
+  /**
+   *  Consumer only, processes what the shards have available without
+   *  waiting: at most max_batch events of every shard, calling
+   *  handler(event, shard, pos) on each.  Every call starts with the
+   *  shard after the one it started with last time, so a busy shard
+   *  cannot starve the others.
+   *
+   *  @return the number of events processed, kEof once every shard ended
+   *  and is drained, kHalted once any shard is halted
+   */
+  template <typename Handler>
+  int64_t poll(Handler&& handler, int64_t max_batch = 64) {
+    if (max_batch < 1)
+      detail::throw_exception<std::runtime_error>("max_batch must be > 0");
+    int64_t processed = 0;
+    size_t ended = 0;
+    for (size_t n = 0; n < shards_.size(); ++n) {
+      auto s = (first_shard_ + n) % shards_.size();
+      auto& shard = shards_[s];
+      auto next_sequence = next_sequences_[s];
+      auto available = shard.consumer->try_wait_for(next_sequence);
+      if (available == kHalted) return kHalted;
+      if (available < next_sequence) {
+        if (available == kEof) ++ended;
+        continue;
+      }
+
+      auto end = std::min(available, next_sequence + max_batch - 1);
+      for (auto pos = next_sequence; pos <= end; ++pos) {
+        handler(static_cast<const EventType&>(shard.ring->at(pos)), s, pos);
+      }
+      shard.consumer->publish(end);
+      next_sequences_[s] = end + 1;
+      processed += end - next_sequence + 1;
+    }
+    first_shard_ = (first_shard_ + 1) % shards_.size();
+    if (ended == shards_.size()) return kEof;
+    return processed;
+  }
+
+  /** ends every shard, the consumer still drains what was published */
+  void set_eof() {
+    for (auto& shard : shards_) shard.producer->set_eof();
+  }
+
+  /** stops every shard right away */
+  void halt() {
+    for (auto& shard : shards_) shard.producer->halt();
+  }
+
+ private:
+  std::vector<Shard> shards_;
+  // which shards are owned by a producer, see claim_shard()
+  std::unique_ptr<std::atomic<bool>[]> claimed_;
+  // consumer only, kept apart from the shards the producers read
+  std::vector<int64_t> next_sequences_;
+  size_t first_shard_ = 0;
+};
+
+}  // namespace disruptor
@@ -0,0 +1,542 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <disruptor/barrier.h>
+#include <disruptor/dynamic_ring_buffer.h>
+#include <disruptor/eof.h>
+#include <disruptor/exceptions.h>
+#include <disruptor/placement.h>
+#include <disruptor/sequence.h>
+#include <disruptor/single_producer_sequencer.h>
+#include <disruptor/span.h>
+#include <disruptor/telemetry.h>
+#include <disruptor/wait_strategy.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace disruptor {
+
+/**
+ *  The producer end of a SharedMemoryRing, the process local counterpart
+ *  of a SingleProducerSequencer whose cursor lives in the shared mapping.
+ *  It claims exactly like one, see detail::SingleProducerClaim.
+ */
+class SharedProducerSequencer {
+ public:
+  /** @param s - the size of the ringbuffer */
+  SharedProducerSequencer(std::shared_ptr<Sequence> cursor, int64_t s)
+      : cursor_(std::move(cursor)), claim_(s, cursor_->acquire()) {}
+
+  /** @param max_lag - see EventCursor::follow(), an evicted consumer gets
+   *  kOverrun from BasicSharedConsumerSequencer::wait_for() */
+  void follow(std::shared_ptr<const Sequence> s,
+              int64_t max_lag = Barrier::kNoLagLimit) {
+    barrier_.follow(std::move(s), max_lag);
+  }
+
+  /** see SingleProducerSequencer::next() */
+  int64_t next(int64_t num = 1) {
+    return claim_.next(num, *cursor_, barrier_, telemetry_);
+  }
+
+  /** see SingleProducerSequencer::try_next() */
+  int64_t try_next(int64_t num = 1) {
+    return claim_.try_next(num, *cursor_, barrier_, telemetry_);
+  }
+
+  /** makes the event at p available to the consumer processes */
+  void publish(int64_t p) {
+    telemetry_.add(Telemetry::kPublishes);
+    cursor_->store(p);
+    cursor_->notify();
+  }
+
+  int64_t remaining_capacity() { return claim_.remaining_capacity(barrier_); }
+  int64_t consumer_lag() { return claim_.consumer_lag(*cursor_, barrier_); }
+
+  /** @return the counters of this process's producer, see
+   *  SingleProducerSequencer::telemetry() */
+  TelemetrySnapshot telemetry() {
+    auto snapshot = telemetry_.snapshot();
+    snapshot.occupancy = consumer_lag();
+    return snapshot;
+  }
+
+  int64_t acquire() const { return cursor_->acquire(); }
+  void set_eof() { cursor_->set_eof(); }
+  void halt() { cursor_->halt(); }
+  bool eof() const { return cursor_->eof(); }
+  bool halted() const { return cursor_->halted(); }
+
+ private:
+  std::shared_ptr<Sequence> cursor_;
+  Barrier barrier_;
+  detail::SingleProducerClaim claim_;
+  Telemetry telemetry_;
+};
+
+/**
+ *  A consumer end of a SharedMemoryRing, the process local counterpart of
+ *  a BasicConsumerSequencer whose cursor lives in the shared mapping.
+ */
+template <typename WaitStrategy>
+class BasicSharedConsumerSequencer {
+ public:
+  template <typename... Args>
+  explicit BasicSharedConsumerSequencer(std::shared_ptr<Sequence> cursor,
+                                        Args&&... args)
+      : cursor_(std::move(cursor)),
+        wait_strategy_(std::forward<Args>(args)...) {}
+
+  void follow(std::shared_ptr<const Sequence> s) {
+    wait_strategy_.attach(*s);
+    barrier_.follow(std::move(s));
+  }
+
+  /**
+   *  @return the highest position available, or kEof / kHalted once the
+   *  stream ended, which is passed on to those following this consumer.
+   *  kOverrun once the producer evicted this consumer, see
+   *  SharedProducerSequencer::follow(), which is not passed on.
+   */
+  int64_t wait_for(int64_t next_sequence) {
+    return forward_end(barrier_.wait_for(next_sequence, wait_strategy_));
+  }
+
+  /** like wait_for(), but returns right away
+   *  @return the highest position available, below next_sequence if there
+   *  is nothing to process yet */
+  int64_t try_wait_for(int64_t next_sequence) {
+    return forward_end(barrier_.try_wait_for(next_sequence));
+  }
+
+  /** makes the event at p available to those following this consumer */
+  void publish(int64_t p) {
+    cursor_->store(p);
+    cursor_->notify();
+  }
+
+  int64_t acquire() const { return cursor_->acquire(); }
+  void set_eof() { cursor_->set_eof(); }
+  void halt() { cursor_->halt(); }
+  bool eof() const { return cursor_->eof(); }
+  bool halted() const { return cursor_->halted(); }
+  /** @return whether the producer evicted this consumer for lagging */
+  bool overrun() const { return cursor_->overrun(); }
+
+ private:
+  int64_t forward_end(int64_t available) {
+    // the slots not read yet may be overwritten already
+    if (cursor_->overrun()) return kOverrun;
+    if (available == kEof) {
+      cursor_->set_eof();
+    } else if (available == kHalted) {
+      cursor_->halt();
+    }
+    return available;
+  }
+
+  std::shared_ptr<Sequence> cursor_;
+  Barrier barrier_;
+  WaitStrategy wait_strategy_;
+};
+
+using SharedConsumerSequencer =
+    BasicSharedConsumerSequencer<SleepingWaitStrategy>;
+
+/**
+ *  A ring buffer, its cursors and the dependencies between its consumers,
+ *  all in one shared memory segment, so that a producer and its consumers
+ *  can run in separate processes.
+ *
+ *  Every process maps the segment at its own address, so the segment only
+ *  holds offsets: the header locates the cursors, a dependency mask per
+ *  consumer and the events.  Each process then attaches as the producer or
+ *  as one of the consumers and gets process local sequencers wired to the
+ *  cursors in the mapping, the handoff itself is the same lock-free
+ *  protocol as within a process.
+ *
+ *  @code
+ *  // setup, consumer 0 and 1 follow the producer, 2 follows both
+ *  auto ring = SharedMemoryRing<Event>::create("/quotes", 1024,
+ *                                              {{}, {}, {0, 1}});
+ *
+ *  // producer process
+ *  auto ring = SharedMemoryRing<Event>::open("/quotes");
+ *  auto producer = ring->producer();
+ *  auto pos = producer->next();
+ *  ring->at(pos) = event;
+ *  producer->publish(pos);
+ *
+ *  // consumer process
+ *  auto ring = SharedMemoryRing<Event>::open("/quotes");
+ *  auto consumer = ring->consumer(2);
+ *  auto next_sequence = consumer->acquire() + 1;
+ *  auto available = consumer->wait_for(next_sequence);
+ *  ...
+ *  consumer->publish(available);
+ *  @endcode
+ *
+ *  Exactly one process may attach as the producer and one per consumer
+ *  index.  Cursors keep their position in the segment, so a restarted
+ *  consumer continues after the last event it published.  Waiters using
+ *  BlockingWaitStrategy are woken across processes.
+ *
+ *  Events are copied between address spaces as raw bytes and must be
+ *  trivially copyable, pointers inside them would be meaningless to the
+ *  other side.
+ */
+template <typename EventType>
+class SharedMemoryRing
+    : public std::enable_shared_from_this<SharedMemoryRing<EventType>> {
+ public:
+  typedef EventType event_type;
+
+  static_assert(std::is_trivially_copyable<EventType>::value,
+                "events shared between processes must be trivially copyable");
+
+  /** consumers are limited by the width of the dependency masks */
+  static constexpr int kMaxConsumers = 63;
+
+  /**
+   *  Creates the named segment, see shm_open(), failing if it exists.
+   *
+   *  @param size - the size of the ringbuffer, must be a power of 2
+   *  @param consumers - for every consumer the indices of the consumers it
+   *  follows, an empty list follows the producer.  A consumer may only
+   *  follow consumers declared before it.
+   *  @param options - huge_pages only advises transparent huge pages here
+   */
+  static std::shared_ptr<SharedMemoryRing> create(
+      const std::string& name, int64_t size,
+      const std::vector<std::vector<int>>& consumers,
+      RingBufferOptions options = {}) {
+    auto fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+      detail::throw_exception<std::system_error>(
+          errno, std::generic_category(), name);
+    DISRUPTOR_TRY {
+      return initialize(fd, size, consumers, options);
+    } DISRUPTOR_CATCH_ALL {
+      shm_unlink(name.c_str());
+      DISRUPTOR_RETHROW;
+    }
+  }
+
+  /** creates an unnamed segment, hand fd() to the other processes by
+   *  fork() or SCM_RIGHTS and open() it there */
+  static std::shared_ptr<SharedMemoryRing> create_anonymous(
+      int64_t size, const std::vector<std::vector<int>>& consumers,
+      RingBufferOptions options = {}) {
+    auto fd = memfd_create("disruptor", MFD_CLOEXEC);
+    if (fd < 0)
+      detail::throw_exception<std::system_error>(
+          errno, std::generic_category(), "memfd_create");
+    return initialize(fd, size, consumers, options);
+  }
+
+  /** attaches to the segment created with create(name, ...) */
+  static std::shared_ptr<SharedMemoryRing> open(
+      const std::string& name, RingBufferOptions options = {}) {
+    auto fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+      detail::throw_exception<std::system_error>(
+          errno, std::generic_category(), name);
+    return attach(fd, options);
+  }
+
+  /** attaches to a segment by descriptor, fd stays owned by the caller */
+  static std::shared_ptr<SharedMemoryRing> open(
+      int fd, RingBufferOptions options = {}) {
+    auto own_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (own_fd < 0)
+      detail::throw_exception<std::system_error>(
+          errno, std::generic_category(), "dup");
+    return attach(own_fd, options);
+  }
+
+  /** removes the name, processes attached keep using the segment */
+  static void unlink(const std::string& name) { shm_unlink(name.c_str()); }
+
+  ~SharedMemoryRing() {
+    munmap(mapping_, bytes_);
+    close(fd_);
+  }
+
+  SharedMemoryRing(const SharedMemoryRing&) = delete;
+  SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+  /** @return a read-only reference to the event at pos */
+  const EventType& at(int64_t pos) const { return _buffer[pos & mask_]; }
+  const EventType& operator[](int64_t pos) const {
+    return _buffer[pos & mask_];
+  }
+
+  /** @return a reference to the event at pos */
+  EventType& at(int64_t pos) { return _buffer[pos & mask_]; }
+  EventType& operator[](int64_t pos) { return _buffer[pos & mask_]; }
+
+  int64_t index(int64_t pos) const { return pos & mask_; }
+  int64_t size() const { return mask_ + 1; }
+
+  /** the events [pos, pos + count) as at most two contiguous ranges */
+  SpanPair<EventType> spans(int64_t pos, int64_t count) {
+    return make_span_pair(_buffer, size(), pos, count);
+  }
+  SpanPair<const EventType> spans(int64_t pos, int64_t count) const {
+    return make_span_pair<const EventType>(_buffer, size(), pos, count);
+  }
+
+  int fd() const { return fd_; }
+  int consumer_count() const { return header_->consumer_count; }
+
+  /** @return the cursor of the producer in this process's mapping */
+  std::shared_ptr<const Sequence> producer_cursor() const { return cursor(0); }
+
+  /** @return the cursor of consumer index in this process's mapping */
+  std::shared_ptr<const Sequence> consumer_cursor(int index) const {
+    check_consumer(index);
+    return cursor(index + 1);
+  }
+
+  /** attaches as the producer, gated by the consumers nobody follows
+   *  @param max_lag - see SharedProducerSequencer::follow() */
+  std::shared_ptr<SharedProducerSequencer> producer(
+      int64_t max_lag = Barrier::kNoLagLimit) {
+    auto producer =
+        std::make_shared<SharedProducerSequencer>(cursor(0), size());
+    uint64_t followed = 0;
+    for (int i = 0; i < consumer_count(); ++i) followed |= dependencies_[i];
+    for (int i = 0; i < consumer_count(); ++i) {
+      if (!(followed & (uint64_t(1) << (i + 1))))
+        producer->follow(cursor(i + 1), max_lag);
+    }
+    return producer;
+  }
+
+  /** attaches as consumer index, any further arguments are forwarded to
+   *  the wait strategy */
+  template <typename WaitStrategy = SleepingWaitStrategy, typename... Args>
+  std::shared_ptr<BasicSharedConsumerSequencer<WaitStrategy>> consumer(
+      int index, Args&&... args) {
+    check_consumer(index);
+    auto consumer =
+        std::make_shared<BasicSharedConsumerSequencer<WaitStrategy>>(
+            cursor(index + 1), std::forward<Args>(args)...);
+    for (int c = 0; c <= kMaxConsumers; ++c) {
+      if (dependencies_[index] & (uint64_t(1) << c))
+        consumer->follow(cursor(c));
+    }
+    return consumer;
+  }
+
+ private:
+  static constexpr uint64_t kMagic = 0x44495352555054ULL;  // "DISRUPT"
+  static constexpr uint32_t kVersion = 1;
+
+  /** the start of the segment, everything else is located by offset */
+  struct Header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t event_size;
+    int64_t size;
+    int32_t consumer_count;
+    uint64_t cursors_offset;
+    uint64_t dependencies_offset;
+    uint64_t events_offset;
+    uint64_t bytes;
+    // set once everything above and the cursors are initialized
+    std::atomic<uint32_t> ready;
+  };
+
+  SharedMemoryRing(int fd, size_t bytes, const RingBufferOptions& options)
+      : fd_(fd), bytes_(bytes) {
+    auto flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (options.prefault) flags |= MAP_POPULATE;
+#endif
+    mapping_ = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, flags, fd_, 0);
+    if (mapping_ == MAP_FAILED) {
+      auto err = errno;
+      close(fd_);
+      detail::throw_exception<std::system_error>(
+          err, std::generic_category(), "shared ring mmap");
+    }
+    header_ = static_cast<Header*>(mapping_);
+  }
+
+  static size_t round_up(size_t bytes, size_t alignment) {
+    return (bytes + alignment - 1) / alignment * alignment;
+  }
+
+  static std::shared_ptr<SharedMemoryRing> initialize(
+      int fd, int64_t size, const std::vector<std::vector<int>>& consumers,
+      const RingBufferOptions& options) {
+    if (size < 1 || (size & (size - 1)) != 0) {
+      close(fd);
+      detail::throw_exception<std::runtime_error>(
+          "Ring buffer's must be a power of 2");
+    }
+    std::vector<uint64_t> masks;
+    DISRUPTOR_TRY {
+      masks = to_masks(consumers);
+    } DISRUPTOR_CATCH_ALL {
+      close(fd);
+      DISRUPTOR_RETHROW;
+    }
+
+    auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto consumer_count = static_cast<int>(consumers.size());
+    auto cursors_offset = round_up(sizeof(Header), kCacheLineSize);
+    auto dependencies_offset =
+        cursors_offset + (consumer_count + 1) * sizeof(Sequence);
+    auto events_offset = round_up(
+        dependencies_offset + consumer_count * sizeof(uint64_t), page_size);
+    auto bytes = round_up(events_offset + size * sizeof(EventType), page_size);
+
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+      auto err = errno;
+      close(fd);
+      detail::throw_exception<std::system_error>(
+          err, std::generic_category(), "ftruncate");
+    }
+    std::shared_ptr<SharedMemoryRing> ring(
+        new SharedMemoryRing(fd, bytes, options));
+
+    auto base = static_cast<char*>(ring->mapping_);
+    auto header = new (base) Header();
+    header->magic = kMagic;
+    header->version = kVersion;
+    header->event_size = sizeof(EventType);
+    header->size = size;
+    header->consumer_count = consumer_count;
+    header->cursors_offset = cursors_offset;
+    header->dependencies_offset = dependencies_offset;
+    header->events_offset = events_offset;
+    header->bytes = bytes;
+    for (int c = 0; c <= consumer_count; ++c) {
+      new (base + cursors_offset + c * sizeof(Sequence)) Sequence(true);
+    }
+    auto dependencies =
+        reinterpret_cast<uint64_t*>(base + dependencies_offset);
+    for (int c = 0; c < consumer_count; ++c) dependencies[c] = masks[c];
+    auto events = reinterpret_cast<EventType*>(base + events_offset);
+    for (int64_t i = 0; i < size; ++i) new (&events[i]) EventType();
+
+    if (options.huge_pages) {
+#ifdef MADV_HUGEPAGE
+      madvise(base + events_offset, bytes - events_offset, MADV_HUGEPAGE);
+#endif
+    }
+    if (options.numa_node >= 0)
+      bind_to_numa_node(ring->mapping_, bytes, options.numa_node);
+
+    header->ready.store(1, std::memory_order_release);
+    ring->locate();
+    return ring;
+  }
+
+  static std::shared_ptr<SharedMemoryRing> attach(
+      int fd, const RingBufferOptions& options) {
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+      auto err = errno;
+      close(fd);
+      detail::throw_exception<std::system_error>(
+          err, std::generic_category(), "fstat");
+    }
+    if (static_cast<size_t>(st.st_size) < sizeof(Header)) {
+      close(fd);
+      detail::throw_exception<std::runtime_error>(
+          "shared ring not initialized");
+    }
+    std::shared_ptr<SharedMemoryRing> ring(
+        new SharedMemoryRing(fd, static_cast<size_t>(st.st_size), options));
+
+    auto header = ring->header_;
+    if (header->ready.load(std::memory_order_acquire) != 1)
+      detail::throw_exception<std::runtime_error>(
+          "shared ring not initialized");
+    if (header->magic != kMagic || header->version != kVersion)
+      detail::throw_exception<std::runtime_error>("not a shared ring");
+    if (header->event_size != sizeof(EventType))
+      detail::throw_exception<std::runtime_error>(
+          "shared ring holds events of another size");
+    if (header->bytes > ring->bytes_)
+      detail::throw_exception<std::runtime_error>("shared ring truncated");
+    if (options.numa_node >= 0)
+      bind_to_numa_node(ring->mapping_, ring->bytes_, options.numa_node);
+    ring->locate();
+    return ring;
+  }
+
+  static std::vector<uint64_t> to_masks(
+      const std::vector<std::vector<int>>& consumers) {
+    if (consumers.empty() ||
+        consumers.size() > static_cast<size_t>(kMaxConsumers))
+      detail::throw_exception<std::logic_error>(
+          "a shared ring needs 1 to 63 consumers");
+
+    std::vector<uint64_t> masks;
+    for (size_t c = 0; c < consumers.size(); ++c) {
+      uint64_t mask = 0;
+      for (auto d : consumers[c]) {
+        if (d < 0 || static_cast<size_t>(d) >= c)
+          detail::throw_exception<std::logic_error>(
+              "consumers may only follow earlier ones");
+        mask |= uint64_t(1) << (d + 1);
+      }
+      masks.push_back(mask ? mask : 1);  // bit 0 is the producer
+    }
+    return masks;
+  }
+
+  /** resolves the offsets in the header to this process's addresses */
+  void locate() {
+    auto base = static_cast<char*>(mapping_);
+    mask_ = header_->size - 1;
+    cursors_ = reinterpret_cast<Sequence*>(base + header_->cursors_offset);
+    dependencies_ =
+        reinterpret_cast<const uint64_t*>(base + header_->dependencies_offset);
+    _buffer = reinterpret_cast<EventType*>(base + header_->events_offset);
+  }
+
+  void check_consumer(int index) const {
+    if (index < 0 || index >= consumer_count())
+      detail::throw_exception<std::out_of_range>("no such consumer");
+  }
+
+  /** cursor 0 is the producer, cursor i + 1 consumer i */
+  std::shared_ptr<Sequence> cursor(int c) const {
+    // shares ownership of the mapping, which must outlive the sequencers
+    return std::shared_ptr<Sequence>(this->shared_from_this(), &cursors_[c]);
+  }
+
+  int fd_;
+  size_t bytes_;
+  void* mapping_ = nullptr;
+  Header* header_ = nullptr;
+  int64_t mask_ = 0;
+  Sequence* cursors_ = nullptr;
+  const uint64_t* dependencies_ = nullptr;
+  EventType* _buffer = nullptr;
+};
+
+}  // namespace disruptor
@@ -5,50 +5,163 @@
 #pragma once
 
 #include <disruptor/event_cursor.h>
+#include <disruptor/exceptions.h>
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include <thread>
 
 namespace disruptor {
 
+namespace detail {
+
 /**
- *  Tracks the write position in a buffer.
- *
- *  Write cursors need to know the size of the buffer
- *  in order to know how much space is available.
+ *  The claiming half of a single producer, over a cursor it does not own,
+ *  shared by SingleProducerSequencer and the producer of a
+ *  SharedMemoryRing, whose cursor lives in the shared mapping.
  */
-class SingleProducerSequencer : public EventCursor {
+class SingleProducerClaim {
  public:
-  /** @param s - the size of the ringbuffer,
-   *  required to do proper wrap detection
-   **/
-  explicit SingleProducerSequencer(int64_t s) : size_(s) {
-    next_sequence_ = Sequence::INIT_SEQUENCE;
-    cached_min_sequence_ = Sequence::INIT_SEQUENCE;
-  }
-
-  int64_t next(int64_t num = 1) {
-    if (num < 1 || num > size_)
-      throw std::runtime_error("num must be > 0 and < size");
+  /** @param s - the size of the ringbuffer
+   *  @param claimed - the last position claimed so far */
+  SingleProducerClaim(int64_t s, int64_t claimed)
+      : size_(s),
+        next_sequence_(claimed),
+        cached_min_sequence_(Sequence::INIT_SEQUENCE),
+        evict_at_(Sequence::INIT_SEQUENCE) {}
 
+  int64_t next(int64_t num, const Sequence& cursor, Barrier& barrier,
+               Telemetry& telemetry) {
+    check(num);
     next_sequence_ += num;
     auto wrap_point = next_sequence_ - size_;
 
-    // make sure there is enough space to write
-    if (wrap_point >= cached_min_sequence_) {
+    // make sure there is enough space to write, and that no consumer lags
+    // behind further than it may
+    if (wrap_point > cached_min_sequence_) {
+      evict_at_ = barrier.evict_laggards(next_sequence_);
+      Telemetry::Stall stall(&telemetry, Telemetry::kClaimStalls);
       int64_t min_sequence;
-      while (wrap_point >= (min_sequence = barrier_.get_min(wrap_point))) {
+      while (wrap_point > (min_sequence = barrier.get_min(wrap_point))) {
+        if (cursor.halted() || barrier.halted()) {
+          next_sequence_ -= num;
+          return kHalted;
+        }
+        stall.idle(Telemetry::kYields);
         std::this_thread::yield();
       }
       cached_min_sequence_ = min_sequence;
+    } else if (next_sequence_ > evict_at_) {
+      evict_at_ = barrier.evict_laggards(next_sequence_);
     }
 
+    telemetry.add(Telemetry::kClaims, num);
     return next_sequence_;
   }
 
- protected:
+  int64_t try_next(int64_t num, const Sequence& cursor, Barrier& barrier,
+                   Telemetry& telemetry) {
+    check(num);
+    auto claim = next_sequence_ + num;
+    auto wrap_point = claim - size_;
+    if (wrap_point > cached_min_sequence_) {
+      evict_at_ = barrier.evict_laggards(claim);
+      auto min_sequence = barrier.get_min(wrap_point);
+      if (wrap_point > min_sequence) {
+        if (cursor.halted() || barrier.halted()) return kHalted;
+        telemetry.add(Telemetry::kClaimFailures);
+        return kInsufficientCapacity;
+      }
+      cached_min_sequence_ = min_sequence;
+    } else if (claim > evict_at_) {
+      evict_at_ = barrier.evict_laggards(claim);
+    }
+
+    next_sequence_ += num;
+    telemetry.add(Telemetry::kClaims, num);
+    return next_sequence_;
+  }
+
+  int64_t remaining_capacity(Barrier& barrier) const {
+    return size_ - (next_sequence_ - gating_min(barrier, next_sequence_));
+  }
+
+  int64_t consumer_lag(const Sequence& cursor, Barrier& barrier) const {
+    auto published = cursor.acquire();
+    return published - gating_min(barrier, published);
+  }
+
+ private:
+  void check(int64_t num) const {
+    if (num < 1 || num > size_)
+      detail::throw_exception<std::runtime_error>(
+          "num must be > 0 and < size");
+  }
+
+  static int64_t gating_min(Barrier& barrier, int64_t pos) {
+    auto min_sequence = barrier.get_min(std::numeric_limits<int64_t>::max());
+    return std::min(min_sequence, pos);
+  }
+
   const int64_t size_;
   int64_t next_sequence_;
   int64_t cached_min_sequence_;
+  // the claim that is due a check for consumers lagging too far behind
+  int64_t evict_at_;
+};
+
+}  // namespace detail
+
+/**
+ *  Tracks the write position in a buffer.
+ *
+ *  Write cursors need to know the size of the buffer
+ *  in order to know how much space is available.
+ */
+class SingleProducerSequencer : public EventCursor {
+ public:
+  /** @param s - the size of the ringbuffer,
+   *  required to do proper wrap detection
+   **/
+  explicit SingleProducerSequencer(int64_t s)
+      : claim_(s, Sequence::INIT_SEQUENCE) {}
+
+  /**
+   *  @return the last claimed slot, or kHalted when this cursor or a
+   *  consumer it waits for is halted while the buffer is full
+   */
+  int64_t next(int64_t num = 1) {
+    return claim_.next(num, *this, barrier_, telemetry_);
+  }
+
+  /**
+   *  Like next(), but never waits for the consumers.
+   *
+   *  @return the last claimed slot, or kInsufficientCapacity if fewer than
+   *  num slots are free, kHalted if they are not because of a halt
+   */
+  int64_t try_next(int64_t num = 1) {
+    return claim_.try_next(num, *this, barrier_, telemetry_);
+  }
+
+  /** @return how many slots can be claimed without waiting */
+  int64_t remaining_capacity() { return claim_.remaining_capacity(barrier_); }
+
+  /** @return how many published events the slowest consumer has yet to
+   *  process */
+  int64_t consumer_lag() { return claim_.consumer_lag(*this, barrier_); }
+
+  /** @return the counters of this cursor, with the consumer_lag() as
+   *  occupancy */
+  TelemetrySnapshot telemetry() {
+    auto snapshot = EventCursor::telemetry();
+    snapshot.occupancy = consumer_lag();
+    return snapshot;
+  }
+
+ private:
+  detail::SingleProducerClaim claim_;
 };
 
 }  // namespace disruptor
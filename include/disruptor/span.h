@@ -0,0 +1,67 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <sys/uio.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace disruptor {
+
+/** A contiguous run of events inside a ring buffer */
+template <typename T>
+struct Span {
+  T* data;
+  size_t size;
+
+  T* begin() const { return data; }
+  T* end() const { return data + size; }
+  bool empty() const { return size == 0; }
+  size_t bytes() const { return size * sizeof(T); }
+};
+
+/**
+ *  A range of events in a ring buffer.  A range never covers more than
+ *  the whole buffer, so it wraps around at most once and splits into at
+ *  most two contiguous spans: first up to the end of the buffer, second
+ *  from its start.  second is empty when the range does not wrap.
+ */
+template <typename T>
+struct SpanPair {
+  Span<T> first;
+  Span<T> second;
+
+  size_t size() const { return first.size + second.size; }
+  size_t bytes() const { return first.bytes() + second.bytes(); }
+
+  /** fills iov with the non empty spans, e.g. for readv()/writev()
+   *  @return the number of iovec entries used */
+  int to_iovec(struct iovec (&iov)[2]) const {
+    int count = 0;
+    for (auto span : {first, second}) {
+      if (span.empty()) continue;
+      iov[count].iov_base = const_cast<void*>(
+          static_cast<const void*>(span.data));
+      iov[count].iov_len = span.bytes();
+      ++count;
+    }
+    return count;
+  }
+};
+
+/** splits [pos, pos + count) of a buffer of size events into spans */
+template <typename T>
+SpanPair<T> make_span_pair(T* buffer, int64_t size, int64_t pos,
+                           int64_t count) {
+  assert(count >= 0 && count <= size);
+  auto index = pos & (size - 1);
+  auto first = count < size - index ? count : size - index;
+  return {{buffer + index, static_cast<size_t>(first)},
+          {buffer, static_cast<size_t>(count - first)}};
+}
+
+}  // namespace disruptor
@@ -0,0 +1,205 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <disruptor/eof.h>
+#include <disruptor/exceptions.h>
+#include <disruptor/ring_buffer.h>
+#include <disruptor/sequence.h>
+#include <disruptor/wait_strategy.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace disruptor {
+
+/**
+ *  One producer, one consumer and the ring between them in a single
+ *  object, the fast path for the most common topology.
+ *
+ *  Each side keeps the last position it saw of the other side's cursor on
+ *  a cache line of its own, and only loads the remote cursor again once
+ *  that copy is used up.  While the ring is neither full nor empty the
+ *  cursor lines are not touched but for the publish itself.  There is no
+ *  Barrier, nothing is allocated and slots are found with a mask known at
+ *  compile time.  Ends are only checked once a side has to wait.
+ *
+ *  @code
+ *  auto channel = std::make_shared<SpscChannel<Event, 1024>>();
+ *
+ *  // producer thread
+ *  auto pos = channel->next();
+ *  channel->at(pos) = event;
+ *  channel->publish(pos);
+ *
+ *  // consumer thread
+ *  auto available_sequence = channel->wait_for(next_sequence);
+ *  if (available_sequence < next_sequence) break;  // kEof or kHalted
+ *  for (; next_sequence <= available_sequence; ++next_sequence) {
+ *    handle(channel->at(next_sequence));
+ *  }
+ *  channel->release(available_sequence);
+ *  @endcode
+ *
+ *  Any constructor arguments are forwarded to the consumer's wait
+ *  strategy, the producer yields while the ring is full.
+ */
+template <typename EventType, uint64_t Size = 1024,
+          typename WaitStrategy = SleepingWaitStrategy>
+class SpscChannel {
+ public:
+  typedef EventType event_type;
+
+  template <typename... Args>
+  explicit SpscChannel(Args&&... args)
+      : wait_strategy_(std::forward<Args>(args)...) {
+    wait_strategy_.attach(write_cursor_);
+  }
+
+  SpscChannel(const SpscChannel&) = delete;
+  SpscChannel& operator=(const SpscChannel&) = delete;
+
+  /**
+   *  Producer only, claims the next num slots.
+   *
+   *  @return the last claimed slot, or kHalted when the channel is halted
+   *  while the ring is full
+   */
+  int64_t next(int64_t num = 1) {
+    if (num < 1 || num > static_cast<int64_t>(Size))
+      detail::throw_exception<std::runtime_error>(
+          "num must be > 0 and < size");
+
+    auto next_sequence = producer_.next_sequence + num;
+    auto wrap_point = next_sequence - static_cast<int64_t>(Size);
+    if (wrap_point > producer_.cached_read) {
+      int64_t read;
+      while (wrap_point > (read = read_cursor_.acquire())) {
+        if (read_cursor_.halted()) return kHalted;
+        std::this_thread::yield();
+      }
+      producer_.cached_read = read;
+    }
+    producer_.next_sequence = next_sequence;
+    return next_sequence;
+  }
+
+  /**
+   *  Like next(), but never waits for the consumer.
+   *
+   *  @return the last claimed slot, or kInsufficientCapacity
+   */
+  int64_t try_next(int64_t num = 1) {
+    if (num < 1 || num > static_cast<int64_t>(Size))
+      detail::throw_exception<std::runtime_error>(
+          "num must be > 0 and < size");
+
+    auto next_sequence = producer_.next_sequence + num;
+    auto wrap_point = next_sequence - static_cast<int64_t>(Size);
+    if (wrap_point > producer_.cached_read) {
+      producer_.cached_read = read_cursor_.acquire();
+      if (wrap_point > producer_.cached_read) return kInsufficientCapacity;
+    }
+    producer_.next_sequence = next_sequence;
+    return next_sequence;
+  }
+
+  /** producer only, makes the slots up to pos available to the consumer */
+  void publish(int64_t pos) {
+    write_cursor_.store(pos);
+    write_cursor_.notify();
+  }
+
+  /**
+   *  Consumer only, waits until next_sequence is published.
+   *
+   *  @return the highest position available, kEof once the producer called
+   *  set_eof() and everything before it is consumed, kHalted once halted
+   */
+  int64_t wait_for(int64_t next_sequence) {
+    if (consumer_.cached_write >= next_sequence) return consumer_.cached_write;
+
+    auto available = write_cursor_.acquire();
+    if (available < next_sequence) {
+      wait_strategy_.wait(write_cursor_, [&] {
+        available = write_cursor_.acquire();
+        return available >= next_sequence || write_cursor_.eof();
+      });
+    }
+    return end_or(available, next_sequence);
+  }
+
+  /** like wait_for(), but returns right away
+   *  @return the highest position available, below next_sequence if there
+   *  is nothing to consume yet */
+  int64_t try_wait_for(int64_t next_sequence) {
+    if (consumer_.cached_write >= next_sequence) return consumer_.cached_write;
+    return end_or(write_cursor_.acquire(), next_sequence);
+  }
+
+  /** consumer only, hands the slots up to pos back to the producer */
+  void release(int64_t pos) { read_cursor_.store(pos); }
+
+  /** the producer is done, the consumer still gets everything published */
+  void set_eof() { write_cursor_.set_eof(); }
+
+  /** stops both sides at their next wait, may be called by either */
+  void halt() {
+    read_cursor_.halt();
+    write_cursor_.halt();
+  }
+
+  const EventType& at(int64_t pos) const { return ring_.at(pos); }
+  EventType& at(int64_t pos) { return ring_.at(pos); }
+  const EventType& operator[](int64_t pos) const { return ring_[pos]; }
+  EventType& operator[](int64_t pos) { return ring_[pos]; }
+
+  /** the slots [pos, pos + count) as at most two contiguous ranges */
+  SpanPair<EventType> spans(int64_t pos, int64_t count) {
+    return ring_.spans(pos, count);
+  }
+  SpanPair<const EventType> spans(int64_t pos, int64_t count) const {
+    return ring_.spans(pos, count);
+  }
+
+  int64_t size() const { return Size; }
+
+  /** the cursors, e.g. to attach an EventFdNotifier to the producer's */
+  const Sequence& producer_cursor() const { return write_cursor_; }
+  const Sequence& consumer_cursor() const { return read_cursor_; }
+
+ private:
+  int64_t end_or(int64_t available, int64_t next_sequence) {
+    if (write_cursor_.eof()) {
+      if (write_cursor_.halted()) return kHalted;
+      // everything published before set_eof() is still consumed
+      available = write_cursor_.acquire();
+      if (available < next_sequence) return kEof;
+    }
+    if (available >= next_sequence) consumer_.cached_write = available;
+    return available;
+  }
+
+  /** written by the producer only */
+  struct alignas(kCacheLineSize) ProducerSide {
+    int64_t next_sequence = Sequence::INIT_SEQUENCE;
+    int64_t cached_read = Sequence::INIT_SEQUENCE;
+  };
+
+  /** written by the consumer only */
+  struct alignas(kCacheLineSize) ConsumerSide {
+    int64_t cached_write = Sequence::INIT_SEQUENCE;
+  };
+
+  Sequence write_cursor_;
+  Sequence read_cursor_;
+  ProducerSide producer_;
+  ConsumerSide consumer_;
+  WaitStrategy wait_strategy_;
+  alignas(kCacheLineSize) RingBuffer<EventType, Size> ring_;
+};
+
+}  // namespace disruptor
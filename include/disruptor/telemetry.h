@@ -0,0 +1,203 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+#include <disruptor/sequence.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ *  Counts claims, publishes and stalls on every cursor when defined to 1,
+ *  see Telemetry.  Off by default, all the counting then compiles away.
+ */
+#ifndef DISRUPTOR_TELEMETRY
+#define DISRUPTOR_TELEMETRY 0
+#endif
+
+namespace disruptor {
+
+/** counters of a cursor at one point in time, all zero unless built with
+ *  DISRUPTOR_TELEMETRY */
+struct TelemetrySnapshot {
+  /** log2 buckets, batch_sizes[b] counts batches of [2^b, 2^(b+1)) events */
+  static constexpr int kBatchBuckets = 16;
+
+  /** slots claimed by next() and try_next() */
+  uint64_t claims = 0;
+  /** try_next() calls that found too few free slots */
+  uint64_t claim_failures = 0;
+  /** publish() / publish_after() calls */
+  uint64_t publishes = 0;
+  /** next() calls that waited for the consumers, and for how long */
+  uint64_t claim_stalls = 0;
+  uint64_t claim_stall_ns = 0;
+  /** wait_for() calls that waited for the cursors followed, and for how
+   *  long */
+  uint64_t wait_stalls = 0;
+  uint64_t wait_stall_ns = 0;
+  /** idle iterations of the wait strategy or of a producer waiting for
+   *  room */
+  uint64_t spins = 0;
+  uint64_t yields = 0;
+  uint64_t sleeps = 0;
+  /** events handed out by every wait_for() */
+  uint64_t batch_sizes[kBatchBuckets] = {};
+  /** producers only: events published and not yet processed by the
+   *  slowest consumer */
+  int64_t occupancy = 0;
+};
+
+#if DISRUPTOR_TELEMETRY
+
+/**
+ *  The counters of one cursor.
+ *
+ *  Every thread counts into a stripe of its own, padded to whole cache
+ *  lines, so the threads sharing a MultiProducerSequencer or a WorkerPool
+ *  do not contend on the counters.  snapshot() sums up the stripes and may
+ *  be called from any thread, e.g. a metrics exporter.
+ */
+class Telemetry {
+ public:
+  enum Counter {
+    kClaims,
+    kClaimFailures,
+    kPublishes,
+    // a stall counter is followed by its duration
+    kClaimStalls,
+    kClaimStallNs,
+    kWaitStalls,
+    kWaitStallNs,
+    kSpins,
+    kYields,
+    kSleeps,
+    kBatchSizes,
+    kCounters = kBatchSizes + TelemetrySnapshot::kBatchBuckets
+  };
+
+  void add(Counter counter, uint64_t n = 1) {
+    auto& value = stripes_[stripe()].counters[counter];
+    value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  void record_batch(int64_t size) {
+    int bucket = 63 - __builtin_clzll(static_cast<uint64_t>(size));
+    if (bucket >= TelemetrySnapshot::kBatchBuckets)
+      bucket = TelemetrySnapshot::kBatchBuckets - 1;
+    add(static_cast<Counter>(kBatchSizes + bucket));
+  }
+
+  TelemetrySnapshot snapshot() const {
+    uint64_t sums[kCounters] = {};
+    for (const auto& stripe : stripes_) {
+      for (int c = 0; c < kCounters; ++c)
+        sums[c] += stripe.counters[c].load(std::memory_order_relaxed);
+    }
+    TelemetrySnapshot snapshot;
+    snapshot.claims = sums[kClaims];
+    snapshot.claim_failures = sums[kClaimFailures];
+    snapshot.publishes = sums[kPublishes];
+    snapshot.claim_stalls = sums[kClaimStalls];
+    snapshot.claim_stall_ns = sums[kClaimStallNs];
+    snapshot.wait_stalls = sums[kWaitStalls];
+    snapshot.wait_stall_ns = sums[kWaitStallNs];
+    snapshot.spins = sums[kSpins];
+    snapshot.yields = sums[kYields];
+    snapshot.sleeps = sums[kSleeps];
+    for (int b = 0; b < TelemetrySnapshot::kBatchBuckets; ++b)
+      snapshot.batch_sizes[b] = sums[kBatchSizes + b];
+    return snapshot;
+  }
+
+  /**
+   *  Times a stall: the clock only starts on the first idle iteration, so
+   *  a call that never waits costs nothing but the construction.
+   */
+  class Stall {
+   public:
+    /** @param telemetry - may be null, nothing is counted then
+     *  @param stalls - kClaimStalls or kWaitStalls */
+    Stall(Telemetry* telemetry, Counter stalls)
+        : telemetry_(telemetry), stalls_(stalls) {}
+
+    ~Stall() {
+      if (start_ == Clock::time_point{}) return;
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          Clock::now() - start_);
+      telemetry_->add(stalls_);
+      telemetry_->add(static_cast<Counter>(stalls_ + 1),
+                      static_cast<uint64_t>(ns.count()));
+    }
+
+    Stall(const Stall&) = delete;
+    Stall& operator=(const Stall&) = delete;
+
+    /** counts one idle iteration, kSpins, kYields or kSleeps */
+    void idle(Counter counter) {
+      if (telemetry_ == nullptr) return;
+      if (start_ == Clock::time_point{}) start_ = Clock::now();
+      telemetry_->add(counter);
+    }
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    Telemetry* telemetry_;
+    const Counter stalls_;
+    Clock::time_point start_{};
+  };
+
+ private:
+  static constexpr size_t kStripes = 8;
+
+  struct alignas(kCacheLineSize) Stripe {
+    std::atomic<uint64_t> counters[kCounters] = {};
+  };
+
+  /** threads are handed out stripes round robin on first use */
+  static size_t stripe() {
+    static std::atomic<size_t> next_stripe{0};
+    thread_local size_t index =
+        next_stripe.fetch_add(1, std::memory_order_relaxed) % kStripes;
+    return index;
+  }
+
+  Stripe stripes_[kStripes];
+};
+
+#else
+
+/** counts nothing, see DISRUPTOR_TELEMETRY */
+class Telemetry {
+ public:
+  enum Counter {
+    kClaims,
+    kClaimFailures,
+    kPublishes,
+    kClaimStalls,
+    kClaimStallNs,
+    kWaitStalls,
+    kWaitStallNs,
+    kSpins,
+    kYields,
+    kSleeps,
+  };
+
+  void add(Counter, uint64_t = 1) {}
+  void record_batch(int64_t) {}
+  TelemetrySnapshot snapshot() const { return {}; }
+
+  class Stall {
+   public:
+    Stall(Telemetry*, Counter) {}
+    void idle(Counter) {}
+  };
+};
+
+#endif
+
+}  // namespace disruptor
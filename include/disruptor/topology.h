@@ -0,0 +1,192 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#include <disruptor/exceptions.h>
+#include <disruptor/sequence.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace disruptor {
+
+/**
+ *  Declares how the consumers of a producer depend on each other and
+ *  wires their barriers accordingly.
+ *
+ *  Every consumer follows the cursors it depends on, or the producer if
+ *  it depends on nothing, and the producer only follows the terminal
+ *  consumers nobody else depends on.  Those gate it transitively, so the
+ *  producer does not have to scan every consumer for wrap detection.
+ *
+ *  @code
+ *  // decode -> (enrich || journal) -> publish
+ *  Topology(producer)
+ *      .then(decode)
+ *      .and_then_parallel(enrich, journal)
+ *      .join(publish)
+ *      .build();
+ *  @endcode
+ *
+ *  Cursors of any type with a follow() method can be used, e.g. every
+ *  BasicConsumerSequencer, so wait strategies see what they follow.
+ */
+class Topology {
+ public:
+  template <typename Producer>
+  explicit Topology(std::shared_ptr<Producer> producer)
+      : producer_(producer), follow_producer_(make_follow(producer)) {}
+
+  /** consumer follows every cursor of the current stage */
+  template <typename Consumer>
+  Topology& then(std::shared_ptr<Consumer> consumer) {
+    add(consumer, stage_);
+    stage_ = {consumer};
+    return *this;
+  }
+
+  /** every consumer follows every cursor of the current stage, and they
+   *  all make up the next stage */
+  template <typename... Consumers>
+  Topology& and_then_parallel(std::shared_ptr<Consumers>... consumers) {
+    std::vector<std::shared_ptr<const Sequence>> stage;
+    int expand[] = {
+        0, (add(consumers, stage_), stage.push_back(consumers), 0)...};
+    (void)expand;
+    stage_ = std::move(stage);
+    return *this;
+  }
+
+  template <typename Consumer>
+  Topology& and_then_parallel(
+      const std::vector<std::shared_ptr<Consumer>>& consumers) {
+    std::vector<std::shared_ptr<const Sequence>> stage;
+    for (auto& consumer : consumers) {
+      add(consumer, stage_);
+      stage.push_back(consumer);
+    }
+    stage_ = std::move(stage);
+    return *this;
+  }
+
+  /** consumer waits for every parallel cursor of the current stage */
+  template <typename Consumer>
+  Topology& join(std::shared_ptr<Consumer> consumer) {
+    return then(std::move(consumer));
+  }
+
+  /**
+   *  Declares an arbitrary dependency, an empty list or the producer means
+   *  consumer follows the producer.  Dependencies may be declared later
+   *  on, build() checks the graph is acyclic.
+   */
+  template <typename Consumer>
+  Topology& add(std::shared_ptr<Consumer> consumer,
+                std::vector<std::shared_ptr<const Sequence>> dependencies) {
+    if (built_)
+      detail::throw_exception<std::logic_error>("topology already built");
+    if (consumer.get() == producer_.get() || find(consumer.get()) >= 0)
+      detail::throw_exception<std::logic_error>(
+          "cursor added to topology twice");
+
+    Node node{consumer, make_follow(consumer), {}};
+    for (auto& dependency : dependencies) {
+      if (dependency.get() != producer_.get())
+        node.dependencies.push_back(std::move(dependency));
+    }
+    nodes_.push_back(std::move(node));
+    return *this;
+  }
+
+  /**
+   *  Checks every dependency is part of the topology and that there are no
+   *  cycles, then wires all barriers.  Nothing is wired if this throws.
+   */
+  void build() {
+    if (built_)
+      detail::throw_exception<std::logic_error>("topology already built");
+
+    std::vector<std::vector<int>> edges(nodes_.size());
+    std::vector<bool> terminal(nodes_.size(), true);
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      for (auto& dependency : nodes_[i].dependencies) {
+        auto d = find(dependency.get());
+        if (d < 0)
+          detail::throw_exception<std::logic_error>(
+              "dependency not in topology");
+        edges[i].push_back(d);
+        terminal[d] = false;
+      }
+    }
+    check_acyclic(edges);
+
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      auto& node = nodes_[i];
+      if (node.dependencies.empty()) node.follow(producer_);
+      for (auto& dependency : node.dependencies) node.follow(dependency);
+      if (terminal[i]) {
+        follow_producer_(node.cursor);
+        terminals_.push_back(node.cursor);
+      }
+    }
+    built_ = true;
+  }
+
+  /** @return the consumers gating the producer, valid after build() */
+  const std::vector<std::shared_ptr<const Sequence>>& gating_sequences()
+      const {
+    return terminals_;
+  }
+
+ private:
+  using Follow = std::function<void(std::shared_ptr<const Sequence>)>;
+
+  struct Node {
+    std::shared_ptr<const Sequence> cursor;
+    Follow follow;
+    std::vector<std::shared_ptr<const Sequence>> dependencies;
+  };
+
+  template <typename Cursor>
+  static Follow make_follow(const std::shared_ptr<Cursor>& cursor) {
+    auto raw = cursor.get();
+    return [raw](std::shared_ptr<const Sequence> s) { raw->follow(s); };
+  }
+
+  int find(const Sequence* cursor) const {
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      if (nodes_[i].cursor.get() == cursor) return static_cast<int>(i);
+    }
+    return -1;
+  }
+
+  static void check_acyclic(const std::vector<std::vector<int>>& edges) {
+    enum { kUnvisited, kVisiting, kDone };
+    std::vector<int> state(edges.size(), kUnvisited);
+    std::function<void(int)> visit = [&](int i) {
+      if (state[i] == kDone) return;
+      if (state[i] == kVisiting)
+        detail::throw_exception<std::logic_error>(
+            "topology has a dependency cycle");
+      state[i] = kVisiting;
+      for (auto d : edges[i]) visit(d);
+      state[i] = kDone;
+    };
+    for (size_t i = 0; i < edges.size(); ++i) visit(static_cast<int>(i));
+  }
+
+  std::shared_ptr<const Sequence> producer_;
+  Follow follow_producer_;
+  std::vector<Node> nodes_;
+  std::vector<std::shared_ptr<const Sequence>> stage_;
+  std::vector<std::shared_ptr<const Sequence>> terminals_;
+  bool built_ = false;
+};
+
+}  // namespace disruptor
@@ -0,0 +1,195 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#include <disruptor/membarrier.h>
+#include <disruptor/sequence.h>
+#include <disruptor/telemetry.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace disruptor {
+
+/** tells the cpu we are in a spin loop, frees pipeline resources for the
+ *  sibling hyper-thread and avoids the memory order mis-speculation penalty
+ *  when the awaited store finally arrives */
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ *  Wait strategies decide how a Barrier idles while a sequence it follows
+ *  is behind.  Every strategy provides
+ *
+ *  @code
+ *  // called once for every sequence the consumer follows
+ *  void attach(const Sequence& seq);
+ *  // returns once ready() returned true, ready() also checks for eof
+ *  template <typename Ready> void wait(const Sequence& seq, Ready&& ready);
+ *  // with DISRUPTOR_TELEMETRY, where to count the time and iterations
+ *  // spent waiting
+ *  void bind(Telemetry& telemetry);
+ *  @endcode
+ *
+ *  A strategy instance belongs to a single consumer and is only used by the
+ *  thread calling wait_for().
+ */
+
+/**
+ *  Lowest latency, burns a whole core while waiting.  Only use it when the
+ *  consumer thread is pinned to a core of its own.
+ */
+class BusySpinWaitStrategy {
+ public:
+  void attach(const Sequence&) {}
+  void bind(Telemetry& telemetry) { telemetry_ = &telemetry; }
+
+  template <typename Ready>
+  void wait(const Sequence&, Ready&& ready) {
+    Telemetry::Stall stall(telemetry_, Telemetry::kWaitStalls);
+    while (!ready()) {
+      stall.idle(Telemetry::kSpins);
+      cpu_relax();
+    }
+  }
+
+ private:
+  Telemetry* telemetry_ = nullptr;
+};
+
+/**
+ *  Spins for a while and then yields the cpu on every retry.  Latency stays
+ *  low and other runnable threads can make progress, but an idle consumer
+ *  still shows up as 100% cpu.
+ */
+class YieldingWaitStrategy {
+ public:
+  explicit YieldingWaitStrategy(int spin_tries = 100)
+      : spin_tries_(spin_tries) {}
+
+  void attach(const Sequence&) {}
+  void bind(Telemetry& telemetry) { telemetry_ = &telemetry; }
+
+  template <typename Ready>
+  void wait(const Sequence&, Ready&& ready) {
+    Telemetry::Stall stall(telemetry_, Telemetry::kWaitStalls);
+    for (int counter = 0; !ready(); ++counter) {
+      if (counter < spin_tries_) {
+        stall.idle(Telemetry::kSpins);
+        cpu_relax();
+      } else {
+        stall.idle(Telemetry::kYields);
+        std::this_thread::yield();
+      }
+    }
+  }
+
+ private:
+  const int spin_tries_;
+  Telemetry* telemetry_ = nullptr;
+};
+
+/**
+ *  Yields for a while and then sleeps, doubling the sleep time on every
+ *  retry from min_sleep_us up to max_sleep_us.  Uses little cpu once the
+ *  queue is idle.  A burst arriving while still yielding is picked up
+ *  within a few micro seconds, once sleeping the first publish may wait
+ *  for up to max_sleep_us, 10 ms by default.
+ */
+class SleepingWaitStrategy {
+ public:
+  explicit SleepingWaitStrategy(int yield_tries = 10000,
+                                useconds_t min_sleep_us = 100,
+                                useconds_t max_sleep_us = 10 * 1000)
+      : yield_tries_(yield_tries),
+        min_sleep_us_(min_sleep_us),
+        max_sleep_us_(std::max(min_sleep_us, max_sleep_us)) {}
+
+  void attach(const Sequence&) {}
+  void bind(Telemetry& telemetry) { telemetry_ = &telemetry; }
+
+  template <typename Ready>
+  void wait(const Sequence&, Ready&& ready) {
+    Telemetry::Stall stall(telemetry_, Telemetry::kWaitStalls);
+    // yield for a while, queue slowing down
+    for (int y = 0; y < yield_tries_; ++y) {
+      if (ready()) return;
+      stall.idle(Telemetry::kYields);
+      std::this_thread::yield();
+    }
+
+    // queue stalled, don't peg the CPU but don't wait too long either...
+    useconds_t sleep_us = min_sleep_us_;
+    while (!ready()) {
+      stall.idle(Telemetry::kSleeps);
+      usleep(sleep_us);
+      sleep_us = std::min(sleep_us * 2, max_sleep_us_);
+    }
+  }
+
+ private:
+  const int yield_tries_;
+  const useconds_t min_sleep_us_;
+  const useconds_t max_sleep_us_;
+  Telemetry* telemetry_ = nullptr;
+};
+
+/**
+ *  Spins briefly and then sleeps until the followed cursor publishes.  Costs
+ *  no cpu while idle, in exchange every publish on a followed cursor has to
+ *  check for sleeping waiters.
+ */
+class BlockingWaitStrategy {
+ public:
+  explicit BlockingWaitStrategy(int spin_tries = 100)
+      : spin_tries_(spin_tries) {}
+
+  /** may follow seq while it is being published to, see join() */
+  void attach(const Sequence& seq) {
+    seq.enable_notify();
+    // publishers that did not see notify enabled published before this,
+    // shared sequences always check for waiters, see Sequence::notify()
+    if (!seq.process_shared()) detail::process_fence();
+  }
+  void bind(Telemetry& telemetry) { telemetry_ = &telemetry; }
+
+  template <typename Ready>
+  void wait(const Sequence& seq, Ready&& ready) {
+    Telemetry::Stall stall(telemetry_, Telemetry::kWaitStalls);
+    for (int s = 0; s < spin_tries_; ++s) {
+      if (ready()) return;
+      stall.idle(Telemetry::kSpins);
+      cpu_relax();
+    }
+
+    while (true) {
+      auto ticket = seq.prepare_wait();
+      if (ready()) {
+        seq.cancel_wait();
+        return;
+      }
+      stall.idle(Telemetry::kSleeps);
+      seq.wait(ticket);
+      seq.cancel_wait();
+    }
+  }
+
+ private:
+  const int spin_tries_;
+  Telemetry* telemetry_ = nullptr;
+};
+
+}  // namespace disruptor
@@ -0,0 +1,132 @@
+//
+// Created by shawnfeng on 10/17/26.
+// Copyright (c) 2021 shawnfeng. All rights reserved.
+//
+#pragma once
+
+#include <disruptor/availability_buffer.h>
+#include <disruptor/eof.h>
+#include <disruptor/event_cursor.h>
+#include <disruptor/exceptions.h>
+#include <disruptor/wait_strategy.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace disruptor {
+
+/**
+ *  A group of workers sharing the events of the cursors it follows,
+ *  every event is handled by exactly one worker.
+ *
+ *  Workers claim small batches from the pool's cursor, so a worker stuck
+ *  on an expensive event does not hold back the others, and mark them
+ *  processed in an AvailabilityBuffer.  Like a MultiProducerSequencer the
+ *  cursor is only an upper bound, whoever follows the pool (the producer
+ *  it gates, or a later stage) sees the highest position processed
+ *  without gaps.
+ *
+ *  @code
+ *  auto pool = std::make_shared<WorkerPool>(ring->size(), 16);
+ *  producer->follow(pool);
+ *  pool->follow(producer);
+ *
+ *  // on every worker thread
+ *  while (pool->work([&](int64_t pos) { handle(ring->at(pos)); })) {
+ *  }
+ *  @endcode
+ *
+ *  Any further constructor arguments are forwarded to the wait strategy,
+ *  each worker waits with its own copy of it.
+ */
+template <typename WaitStrategy>
+class BasicWorkerPool : public EventCursor {
+ private:
+  using EventCursor::publish;
+
+ public:
+  /** @param s - the size of the ringbuffer, must be a power of 2
+   *  @param batch_size - how many events a worker claims at once
+   **/
+  template <typename... Args>
+  explicit BasicWorkerPool(int64_t s, int64_t batch_size = 1, Args&&... args)
+      : batch_size_(batch_size),
+        processed_(s),
+        wait_strategy_(std::forward<Args>(args)...) {
+    if (batch_size < 1 || batch_size > s)
+      detail::throw_exception<std::runtime_error>(
+          "batch size must be > 0 and <= size");
+    set_availability(&processed_);
+#if DISRUPTOR_TELEMETRY
+    wait_strategy_.bind(telemetry_);
+#endif
+  }
+
+  template <typename T>
+  void follow(T&& s) {
+    wait_strategy_.attach(*s);
+    EventCursor::follow(std::forward<T>(s));
+  }
+
+  /** claims the next num events for the calling worker
+   *  @return the last claimed position */
+  int64_t claim(int64_t num = 1) {
+    telemetry_.add(Telemetry::kClaims, num);
+    return increment_and_get(num);
+  }
+
+  /** waits until the followed cursors published pos, workers wait out of
+   *  order so nothing is assumed about the positions below pos
+   *  @return the highest position available to workers, or kEof / kHalted
+   *  once the stream ended */
+  int64_t wait_for(int64_t pos) {
+    WaitStrategy wait_strategy = wait_strategy_;
+    auto available = barrier_.wait_for_unordered(pos, wait_strategy);
+    if (available >= pos) telemetry_.record_batch(available - pos + 1);
+    return forward_end(available);
+  }
+
+  /** like wait_for(), but returns right away
+   *  @return the highest position available, below pos if there is
+   *  nothing to process yet */
+  int64_t try_wait_for(int64_t pos) {
+    return forward_end(barrier_.try_wait_for_unordered(pos));
+  }
+
+  /** marks the claimed events [begin, end] as processed */
+  void complete(int64_t begin, int64_t end) {
+    telemetry_.add(Telemetry::kPublishes);
+    processed_.set_available(begin, end);
+    notify();
+  }
+
+  /**
+   *  Claims a batch, calls handler(pos) for every event in it as soon as
+   *  it is available and marks the events processed along the way.
+   *
+   *  @return false once the stream ended, the worker should then stop
+   */
+  template <typename Handler>
+  bool work(Handler&& handler) {
+    auto end = claim(batch_size_);
+    for (auto pos = end - batch_size_ + 1; pos <= end;) {
+      auto begin = pos;
+      auto available = wait_for(pos);
+      if (available < pos) return false;
+      available = std::min(available, end);
+      for (; pos <= available; ++pos) handler(pos);
+      complete(begin, available);
+    }
+    return true;
+  }
+
+ private:
+  const int64_t batch_size_;
+  AvailabilityBuffer processed_;
+  WaitStrategy wait_strategy_;
+};
+
+using WorkerPool = BasicWorkerPool<SleepingWaitStrategy>;
+
+}  // namespace disruptor
@@ -0,0 +1,202 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../slog.h"
+
+static_assert(__cpp_impl_coroutine, "built as C++20");
+
+namespace {
+
+/** a coroutine that starts right away and is never awaited */
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+using Consumer = disruptor::AsyncConsumer<disruptor::ConsumerSequencer>;
+using Producer = disruptor::AsyncProducer<disruptor::SingleProducerSequencer>;
+
+Detached sum_all(Consumer& consumer,
+                 std::shared_ptr<disruptor::ConsumerSequencer> sequence,
+                 const disruptor::RingBuffer<int64_t, 64>& ring,
+                 int64_t& sum, int64_t& batches) {
+  int64_t next_sequence = 0;
+  while (true) {
+    auto available = co_await consumer.next_batch(next_sequence);
+    if (available < next_sequence) break;
+    for (; next_sequence <= available; ++next_sequence) {
+      sum += ring.at(next_sequence);
+    }
+    sequence->publish(available);
+    ++batches;
+  }
+}
+
+Detached produce(Producer& producer,
+                 std::shared_ptr<disruptor::SingleProducerSequencer> sequence,
+                 disruptor::RingBuffer<int64_t, 64>& ring, int64_t count,
+                 int64_t& last) {
+  for (int64_t i = 0; i < count; ++i) {
+    auto pos = co_await producer.claim();
+    if (pos < 0) {
+      last = pos;
+      co_return;
+    }
+    ring.at(pos) = i;
+    sequence->publish(pos);
+    last = pos;
+  }
+}
+
+}  // namespace
+
+/** one thread consumes several rings, each fed by a thread of its own */
+TEST(coroutine, one_thread_many_rings) {
+  static constexpr int kRings = 4;
+  static constexpr int64_t kIterations = 50 * 1000;
+
+  struct Ring {
+    disruptor::RingBuffer<int64_t, 64> data;
+    std::shared_ptr<disruptor::SingleProducerSequencer> producer =
+        std::make_shared<disruptor::SingleProducerSequencer>(64);
+    std::shared_ptr<disruptor::ConsumerSequencer> consumer =
+        std::make_shared<disruptor::ConsumerSequencer>();
+    int64_t sum = 0;
+    int64_t batches = 0;
+  };
+
+  disruptor::CoroutineScheduler scheduler;
+  std::vector<std::unique_ptr<Ring>> rings;
+  std::vector<std::unique_ptr<Consumer>> consumers;
+  for (int r = 0; r < kRings; ++r) {
+    rings.emplace_back(new Ring);
+    auto& ring = *rings.back();
+    ring.producer->follow(ring.consumer);
+    ring.consumer->follow(ring.producer);
+    scheduler.attach(*ring.producer);
+    consumers.emplace_back(new Consumer(scheduler, ring.consumer));
+  }
+
+  for (int r = 0; r < kRings; ++r) {
+    auto& ring = *rings[r];
+    sum_all(*consumers[r], ring.consumer, ring.data, ring.sum, ring.batches);
+  }
+  EXPECT_FALSE(scheduler.empty());
+
+  std::vector<std::thread> producers;
+  for (int r = 0; r < kRings; ++r) {
+    producers.emplace_back([&, r] {
+      auto& ring = *rings[r];
+      for (int64_t i = 0; i < kIterations; ++i) {
+        auto pos = ring.producer->next();
+        ring.data.at(pos) = i;
+        ring.producer->publish(pos);
+      }
+      ring.producer->set_eof();
+    });
+  }
+
+  scheduler.run();
+  for (auto& t : producers) t.join();
+
+  for (auto& ring : rings) {
+    EXPECT_EQ(ring->sum, kIterations * (kIterations - 1) / 2);
+    EXPECT_GT(ring->batches, 0);
+  }
+}
+
+/** a producer coroutine suspends on a full ring until the consumer moves */
+TEST(coroutine, claim_waits_for_space) {
+  disruptor::RingBuffer<int64_t, 64> data;
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(64);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  disruptor::CoroutineScheduler scheduler;
+  scheduler.attach(*consumer_sequence);
+  Producer producer(scheduler, producer_sequence);
+
+  int64_t last = disruptor::Sequence::INIT_SEQUENCE;
+  produce(producer, producer_sequence, data, 100, last);
+  // the first 64 claims never suspend
+  EXPECT_EQ(last, 63);
+  EXPECT_FALSE(scheduler.empty());
+  EXPECT_EQ(scheduler.poll(), 0u);
+
+  std::thread consumer{[&] {
+    int64_t next_sequence = 0;
+    while (next_sequence < 100) {
+      auto available = consumer_sequence->wait_for(next_sequence);
+      for (; next_sequence <= available; ++next_sequence) {
+        EXPECT_EQ(data.at(next_sequence), next_sequence);
+      }
+      consumer_sequence->publish(available);
+    }
+  }};
+
+  scheduler.run();
+  consumer.join();
+  EXPECT_EQ(last, 99);
+}
+
+/** suspended coroutines are resumed with kHalted */
+TEST(coroutine, halt_resumes) {
+  disruptor::RingBuffer<int64_t, 64> data;
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(64);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  disruptor::CoroutineScheduler scheduler;
+  scheduler.attach(*consumer_sequence);
+  Producer producer(scheduler, producer_sequence);
+
+  int64_t last = disruptor::Sequence::INIT_SEQUENCE;
+  produce(producer, producer_sequence, data, 100, last);
+  EXPECT_EQ(last, 63);
+
+  std::thread stopper{[&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    consumer_sequence->halt();
+  }};
+  scheduler.run();
+  stopper.join();
+  EXPECT_EQ(last, disruptor::kHalted);
+}
+
+/** publishers only pay for waking the scheduler while it sleeps */
+TEST(coroutine, attached_only_while_parked) {
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(64);
+  {
+    disruptor::CoroutineScheduler scheduler;
+    scheduler.attach(*producer_sequence);
+    EXPECT_EQ(producer_sequence->notify_enabled(),
+              !disruptor::detail::process_fence_available());
+    EXPECT_TRUE(scheduler.detach(*producer_sequence));
+    EXPECT_FALSE(scheduler.detach(*producer_sequence));
+    EXPECT_FALSE(producer_sequence->notify_enabled());
+
+    disruptor::Sequence shared(true);
+    EXPECT_THROW(scheduler.attach(shared), std::logic_error);
+    scheduler.attach(*producer_sequence);
+  }
+  // the scheduler is gone, nothing is left to signal
+  EXPECT_FALSE(producer_sequence->notify_enabled());
+  producer_sequence->publish(producer_sequence->next());
+}
@@ -0,0 +1,61 @@
+// Built with -fno-exceptions: the whole library must compile without them
+// and a pipeline must still drain and halt.
+#include <disruptor/disruptor.h>
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+namespace {
+
+int64_t consume(disruptor::ConsumerSequencer& consumer,
+                const disruptor::RingBuffer<int64_t, 64>& ring) {
+  int64_t sum = 0;
+  auto next_sequence = consumer.acquire() + 1;
+  while (true) {
+    auto available_sequence = consumer.wait_for(next_sequence);
+    if (available_sequence < next_sequence) break;
+    for (; next_sequence <= available_sequence; ++next_sequence) {
+      sum += ring.at(next_sequence);
+    }
+    consumer.publish(available_sequence);
+  }
+  return sum;
+}
+
+}  // namespace
+
+int main() {
+  static constexpr int64_t kIterations = 10 * 1000;
+
+  auto ring = std::make_shared<disruptor::RingBuffer<int64_t, 64>>();
+  auto producer = std::make_shared<disruptor::SingleProducerSequencer>(64);
+  auto consumer = std::make_shared<disruptor::ConsumerSequencer>();
+  producer->follow(consumer);
+  consumer->follow(producer);
+
+  int64_t sum = 0;
+  std::thread consumer_thread{[&] { sum = consume(*consumer, *ring); }};
+  for (int64_t i = 0; i < kIterations; ++i) {
+    disruptor::publish_event(
+        *ring, *producer,
+        [](int64_t& event, int64_t, int64_t value) { event = value; }, i);
+  }
+  producer->set_eof();
+  consumer_thread.join();
+  if (sum != kIterations * (kIterations - 1) / 2) {
+    std::fprintf(stderr, "drain lost events: sum %ld\n", sum);
+    return 1;
+  }
+
+  auto halted = std::make_shared<disruptor::SingleProducerSequencer>(64);
+  auto follower = std::make_shared<disruptor::ConsumerSequencer>();
+  follower->follow(halted);
+  halted->publish(halted->next(8));
+  halted->halt();
+  if (follower->wait_for(0) != disruptor::kHalted) {
+    std::fprintf(stderr, "halt not reported\n");
+    return 1;
+  }
+  return 0;
+}
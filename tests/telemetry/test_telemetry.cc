@@ -0,0 +1,119 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <thread>
+
+#include "../slog.h"
+
+static_assert(DISRUPTOR_TELEMETRY, "built with DISRUPTOR_TELEMETRY=1");
+
+TEST(telemetry, counters) {
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(8);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  producer_sequence->publish(producer_sequence->next(8));
+  EXPECT_LT(producer_sequence->try_next(), 0);
+
+  auto producer = producer_sequence->telemetry();
+  EXPECT_EQ(producer.claims, 8);
+  EXPECT_EQ(producer.claim_failures, 1);
+  EXPECT_EQ(producer.publishes, 1);
+  EXPECT_EQ(producer.claim_stalls, 0);
+  EXPECT_EQ(producer.occupancy, 8);
+
+  EXPECT_EQ(consumer_sequence->wait_for(0), 7);
+  consumer_sequence->publish(7);
+  EXPECT_EQ(producer_sequence->telemetry().occupancy, 0);
+
+  auto consumer = consumer_sequence->telemetry();
+  EXPECT_EQ(consumer.publishes, 1);
+  EXPECT_EQ(consumer.wait_stalls, 0);
+  // 8 events in a single batch
+  EXPECT_EQ(consumer.batch_sizes[3], 1);
+}
+
+TEST(telemetry, stalls) {
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(8);
+  auto consumer_sequence = std::make_shared<
+      disruptor::BasicConsumerSequencer<disruptor::YieldingWaitStrategy>>(10);
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  // the consumer waits for the producer
+  std::thread producer{[=] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    producer_sequence->publish(producer_sequence->next(8));
+  }};
+  EXPECT_EQ(consumer_sequence->wait_for(0), 7);
+  producer.join();
+
+  auto consumer = consumer_sequence->telemetry();
+  EXPECT_EQ(consumer.wait_stalls, 1);
+  EXPECT_GE(consumer.wait_stall_ns, 1000 * 1000);
+  EXPECT_EQ(consumer.spins, 10);
+  EXPECT_GT(consumer.yields, 0);
+
+  // and the producer for the consumer
+  std::thread consumer_thread{[=] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    consumer_sequence->publish(7);
+  }};
+  EXPECT_EQ(producer_sequence->next(), 8);
+  consumer_thread.join();
+
+  auto producer_stats = producer_sequence->telemetry();
+  EXPECT_EQ(producer_stats.claim_stalls, 1);
+  EXPECT_GE(producer_stats.claim_stall_ns, 1000 * 1000);
+  EXPECT_GT(producer_stats.yields, 0);
+  LOGGER_DEBUG("consumer stalled %lu ns, producer %lu ns",
+               consumer.wait_stall_ns, producer_stats.claim_stall_ns);
+}
+
+/** the producers share a cursor but count on stripes of their own */
+TEST(telemetry, multi_producer) {
+  static constexpr int kProduceThreadNum = 3;
+  static constexpr int64_t kIterations = 100 * 1000;
+
+  auto producer_sequence =
+      std::make_shared<disruptor::MultiProducerSequencer>(1024);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  std::array<std::thread, kProduceThreadNum> produce_threads;
+  for (auto& p : produce_threads) {
+    p = std::thread{[&] {
+      for (int64_t i = 0; i < kIterations; ++i) {
+        auto pos = producer_sequence->next();
+        producer_sequence->publish_after(pos, pos - 1);
+      }
+    }};
+  }
+
+  const int64_t total = kIterations * kProduceThreadNum;
+  auto next_sequence = consumer_sequence->acquire() + 1;
+  while (next_sequence < total) {
+    auto available_sequence = consumer_sequence->wait_for(next_sequence);
+    next_sequence = available_sequence + 1;
+    consumer_sequence->publish(available_sequence);
+  }
+  for (auto& p : produce_threads) p.join();
+
+  auto producer = producer_sequence->telemetry();
+  EXPECT_EQ(producer.claims, total);
+  EXPECT_EQ(producer.publishes, total);
+  EXPECT_EQ(producer.occupancy, 0);
+
+  auto consumer = consumer_sequence->telemetry();
+  uint64_t batches = 0;
+  for (auto b : consumer.batch_sizes) batches += b;
+  EXPECT_EQ(batches, consumer.publishes);
+  LOGGER_DEBUG("%lu batches, %lu producer stalls", batches,
+               producer.claim_stalls);
+}
@@ -0,0 +1,108 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "slog.h"
+
+namespace {
+
+struct CountingHandler {
+  std::shared_ptr<disruptor::ConsumerSequencer> consumer;
+  std::atomic<int64_t>* processed;
+  int64_t next = 0;
+  int64_t batches = 0;
+  int64_t batch_size = 0;
+  int64_t largest_batch = 0;
+  int64_t largest_lag = 0;
+
+  void on_event(const int64_t& event, int64_t pos, bool end_of_batch) {
+    ASSERT_EQ(event, pos);
+    ASSERT_EQ(pos, next++);
+    // progress published within the batch keeps the producer going
+    largest_lag = std::max(largest_lag, pos - consumer->acquire());
+    ++batch_size;
+    if (end_of_batch) {
+      ++batches;
+      largest_batch = std::max(largest_batch, batch_size);
+      batch_size = 0;
+    }
+    processed->fetch_add(1, std::memory_order_release);
+  }
+};
+
+}  // namespace
+
+TEST(batch_event_processor, batches) {
+  static constexpr int64_t kSize = 1024;
+  static constexpr int64_t kIterations = 200 * 1000;
+
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(
+          source_data->size());
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  std::atomic<int64_t> processed{0};
+  disruptor::BatchOptions options;
+  options.max_batch_size = 64;
+  options.publish_interval = 16;
+  auto processor = disruptor::make_batch_event_processor(
+      source_data, consumer_sequence,
+      CountingHandler{consumer_sequence, &processed}, options);
+  std::thread consumer{[&] { processor.run(); }};
+
+  for (int64_t i = 0; i < kIterations; ++i) {
+    auto pos = producer_sequence->next();
+    source_data->at(pos) = pos;
+    producer_sequence->publish(pos);
+  }
+  while (processed.load(std::memory_order_acquire) < kIterations)
+    std::this_thread::yield();
+  producer_sequence->set_eof();
+  consumer.join();
+
+  auto& handler = processor.handler();
+  EXPECT_EQ(handler.next, kIterations);
+  EXPECT_EQ(handler.batch_size, 0);
+  EXPECT_LE(handler.largest_batch, options.max_batch_size);
+  EXPECT_LE(handler.largest_lag, options.publish_interval);
+  EXPECT_EQ(consumer_sequence->acquire(), kIterations - 1);
+  LOGGER_DEBUG("%ld events in %ld batches, largest %ld", handler.next,
+               handler.batches, handler.largest_batch);
+}
+
+TEST(batch_event_processor, process_batch) {
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, 8>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(8);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  auto end = producer_sequence->next(5);
+  for (int64_t pos = 0; pos <= end; ++pos) source_data->at(pos) = pos;
+  producer_sequence->publish(end);
+
+  std::atomic<int64_t> processed{0};
+  disruptor::BatchOptions options;
+  options.max_batch_size = 3;
+  auto processor = disruptor::make_batch_event_processor(
+      source_data, consumer_sequence,
+      CountingHandler{consumer_sequence, &processed}, options);
+  EXPECT_EQ(processor.process_batch(), 3);
+  EXPECT_EQ(consumer_sequence->acquire(), 2);
+  EXPECT_EQ(processor.process_batch(), 2);
+  EXPECT_EQ(consumer_sequence->acquire(), 4);
+  EXPECT_EQ(processor.handler().batches, 2);
+
+  EXPECT_THROW(disruptor::make_batch_event_processor(
+                   source_data, consumer_sequence,
+                   CountingHandler{consumer_sequence, &processed},
+                   disruptor::BatchOptions{-1, 0}),
+               std::runtime_error);
+}
@@ -0,0 +1,100 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "slog.h"
+
+namespace {
+
+double now() {
+  struct timespec tp {};
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return (double)(tp.tv_sec) + (double)tp.tv_nsec / 1000 / 1000 / 1000;
+}
+
+/** the n-th message, between 0 and 299 bytes long */
+std::string message(int64_t n) {
+  std::string text(static_cast<size_t>(n * 37 % 300), ' ');
+  for (size_t i = 0; i < text.size(); ++i) text[i] = 'a' + (n + i) % 26;
+  return text;
+}
+
+}  // namespace
+
+TEST(byte_ring_buffer, framing) {
+  disruptor::ByteRingBuffer ring(256);
+  disruptor::SingleProducerSequencer producer(ring.size());
+  EXPECT_EQ(ring.max_message_size(), 120);
+  EXPECT_EQ(disruptor::ByteRingBuffer::record_bytes(0), 8);
+  EXPECT_EQ(disruptor::ByteRingBuffer::record_bytes(1), 16);
+  EXPECT_EQ(disruptor::ByteRingBuffer::record_bytes(8), 16);
+  EXPECT_THROW(ring.claim(producer, 121), std::runtime_error);
+  EXPECT_THROW(disruptor::ByteRingBuffer(16), std::runtime_error);
+
+  std::vector<std::string> published;
+  int64_t next_sequence = 0;
+  // 100 bytes take up 112, the third message wraps after 224 bytes
+  for (auto text : {"first", "second", "third"}) {
+    std::string payload(100, text[0]);
+    auto claim = ring.claim(producer, payload.size());
+    ASSERT_EQ(claim.data.size, payload.size());
+    memcpy(claim.data.data, payload.data(), payload.size());
+    producer.publish(claim.end);
+
+    for (auto m : ring.messages(next_sequence, claim.end)) {
+      published.emplace_back(m.data, m.size);
+    }
+    next_sequence = claim.end + 1;
+  }
+  // padding over the last 32 bytes and the 80 claimed at the start
+  EXPECT_EQ(next_sequence, 4 * 112);
+  ASSERT_EQ(published.size(), 3);
+  EXPECT_EQ(published[2], std::string(100, 't'));
+  EXPECT_EQ(ring.messages(0, -1).begin(), ring.messages(0, -1).end());
+}
+
+TEST(byte_ring_buffer, one_producer_one_consumer) {
+  static constexpr int64_t kIterations = 200 * 1000;
+
+  disruptor::ByteRingBuffer ring(1 << 12);
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(ring.size());
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  int64_t bytes = 0;
+  auto start = now();
+  std::thread producer{[&] {
+    for (int64_t n = 0; n < kIterations; ++n) {
+      auto text = message(n);
+      auto claim = ring.claim(*producer_sequence, text.size());
+      memcpy(claim.data.data, text.data(), text.size());
+      producer_sequence->publish(claim.end);
+      bytes += text.size();
+    }
+  }};
+
+  int64_t received = 0;
+  auto next_sequence = consumer_sequence->acquire() + 1;
+  while (received < kIterations) {
+    auto available_sequence = consumer_sequence->wait_for(next_sequence);
+    for (auto m : ring.messages(next_sequence, available_sequence)) {
+      ASSERT_EQ(std::string(m.data, m.size), message(received));
+      ++received;
+    }
+    consumer_sequence->publish(available_sequence);
+    next_sequence = available_sequence + 1;
+  }
+  producer.join();
+
+  EXPECT_EQ(received, kIterations);
+  LOGGER_DEBUG("byte ring 1 producer - 1 consumer %f M msgs/secs, %f MB/s",
+               received / (now() - start) / 1000.0 / 1000.0,
+               bytes / (now() - start) / 1000.0 / 1000.0);
+}
@@ -0,0 +1,216 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "slog.h"
+
+/** a tap attached while the producer keeps publishing */
+TEST(dynamic_consumers, attach) {
+  static constexpr int64_t kSize = 64;
+  static constexpr int64_t kIterations = 1000 * 1000;
+
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  auto consume = [&](std::shared_ptr<disruptor::ConsumerSequencer> consumer,
+                     int64_t next_sequence, int64_t* count) {
+    while (next_sequence < kIterations) {
+      auto available_sequence = consumer->wait_for(next_sequence);
+      for (; next_sequence <= available_sequence; ++next_sequence) {
+        ASSERT_EQ(source_data->at(next_sequence), next_sequence);
+        ++*count;
+      }
+      consumer->publish(available_sequence);
+    }
+  };
+
+  int64_t consumed = 0;
+  std::thread consumer{consume, consumer_sequence, 0, &consumed};
+  std::thread producer{[&] {
+    for (int64_t i = 0; i < kIterations; ++i) {
+      auto pos = producer_sequence->next();
+      source_data->at(pos) = pos;
+      producer_sequence->publish(pos);
+    }
+  }};
+
+  while (producer_sequence->acquire() < kIterations / 4)
+    std::this_thread::yield();
+  auto tap_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  tap_sequence->follow(producer_sequence);
+  auto skipped = tap_sequence->join();
+  producer_sequence->follow(tap_sequence);
+  EXPECT_GE(skipped, kIterations / 4);
+
+  int64_t tapped = 0;
+  std::thread tap{consume, tap_sequence, skipped + 1, &tapped};
+  producer.join();
+  consumer.join();
+  tap.join();
+
+  EXPECT_EQ(consumed, kIterations);
+  EXPECT_EQ(tapped, kIterations - skipped - 1);
+  LOGGER_DEBUG("tap joined at %ld", skipped);
+}
+
+/** a consumer that stopped is detached, the producer carries on */
+TEST(dynamic_consumers, detach) {
+  static constexpr int64_t kSize = 64;
+  static constexpr int64_t kIterations = 10 * 1000;
+
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  auto stuck_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  for (auto& c : {consumer_sequence, stuck_sequence}) {
+    producer_sequence->follow(c);
+    c->follow(producer_sequence);
+  }
+
+  std::thread consumer{[&] {
+    auto next_sequence = consumer_sequence->acquire() + 1;
+    while (next_sequence < kIterations) {
+      auto available_sequence = consumer_sequence->wait_for(next_sequence);
+      next_sequence = available_sequence + 1;
+      consumer_sequence->publish(available_sequence);
+    }
+  }};
+  std::atomic<bool> done{false};
+  std::thread producer{[&] {
+    for (int64_t i = 0; i < kIterations; ++i)
+      producer_sequence->publish(producer_sequence->next());
+    done = true;
+  }};
+
+  // the producer fills the ring and then waits for the stuck consumer
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(done.load());
+  EXPECT_EQ(producer_sequence->acquire(), kSize - 1);
+  EXPECT_TRUE(producer_sequence->unfollow(*stuck_sequence));
+  EXPECT_FALSE(producer_sequence->unfollow(*stuck_sequence));
+
+  producer.join();
+  consumer.join();
+  EXPECT_TRUE(done.load());
+  EXPECT_EQ(producer_sequence->acquire(), kIterations - 1);
+}
+
+/** the gating set changes over and over while the producer reads it */
+TEST(dynamic_consumers, churn) {
+  static constexpr int64_t kIterations = 200 * 1000;
+
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(1024);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  std::atomic<bool> done{false};
+  std::thread churn{[&] {
+    while (!done.load()) {
+      auto tap_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+      tap_sequence->follow(producer_sequence);
+      tap_sequence->join();
+      producer_sequence->follow(tap_sequence);
+      std::this_thread::yield();
+      // a tap that keeps up a little before it goes away
+      tap_sequence->publish(producer_sequence->acquire());
+      producer_sequence->unfollow(*tap_sequence);
+    }
+  }};
+
+  std::thread producer{[&] {
+    for (int64_t i = 0; i < kIterations; ++i)
+      producer_sequence->publish(producer_sequence->next());
+  }};
+
+  auto next_sequence = consumer_sequence->acquire() + 1;
+  while (next_sequence < kIterations) {
+    auto available_sequence = consumer_sequence->wait_for(next_sequence);
+    next_sequence = available_sequence + 1;
+    consumer_sequence->publish(available_sequence);
+  }
+  producer.join();
+  done = true;
+  churn.join();
+  EXPECT_EQ(producer_sequence->acquire(), kIterations - 1);
+}
+
+/** joining several producers mid stream stops below a slot still being
+ *  written, however long the stream has been running */
+TEST(dynamic_consumers, join_multi_producer) {
+  static constexpr int64_t kSize = 8;
+
+  auto producer_sequence =
+      std::make_shared<disruptor::MultiProducerSequencer>(kSize);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  int64_t next_sequence = 0;
+  for (int64_t i = 0; i < 1000; ++i) {
+    auto pos = producer_sequence->next();
+    producer_sequence->publish_after(pos, pos - 1);
+    next_sequence = consumer_sequence->wait_for(next_sequence) + 1;
+    consumer_sequence->publish(next_sequence - 1);
+  }
+
+  auto slow = producer_sequence->next();
+  for (int i = 0; i < 3; ++i) {
+    auto pos = producer_sequence->next();
+    producer_sequence->publish_after(pos, pos - 1);
+  }
+
+  auto tap = std::make_shared<disruptor::ConsumerSequencer>();
+  tap->follow(producer_sequence);
+  EXPECT_EQ(tap->join(), slow - 1);
+
+  producer_sequence->publish_after(slow, slow - 1);
+  EXPECT_EQ(tap->wait_for(slow), slow + 3);
+}
+
+/** a blocking tap joins a live stream and is woken by every publish */
+TEST(dynamic_consumers, join_blocking) {
+  static constexpr int64_t kSize = 64;
+  static constexpr int64_t kIterations = 200 * 1000;
+  using BlockingConsumer =
+      disruptor::BasicConsumerSequencer<disruptor::BlockingWaitStrategy>;
+
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  std::thread producer{[&] {
+    for (int64_t i = 0; i < kIterations; ++i) {
+      producer_sequence->publish(producer_sequence->next());
+      // pauses now and then, so the taps go to sleep
+      if (i % 1000 == 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    producer_sequence->set_eof();
+  }};
+
+  int taps = 0;
+  while (!producer_sequence->eof()) {
+    auto tap = std::make_shared<BlockingConsumer>(1);
+    tap->follow(producer_sequence);
+    auto next_sequence = tap->join() + 1;
+    producer_sequence->follow(tap);
+    // a missed wake-up leaves the tap asleep for good
+    for (int b = 0; b < 3; ++b) {
+      auto available_sequence = tap->wait_for(next_sequence);
+      if (available_sequence < next_sequence) break;
+      tap->publish(available_sequence);
+      next_sequence = available_sequence + 1;
+    }
+    producer_sequence->unfollow(*tap);
+    ++taps;
+  }
+  producer.join();
+  LOGGER_DEBUG("%d taps joined", taps);
+}
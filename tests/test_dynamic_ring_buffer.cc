@@ -0,0 +1,66 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#include "slog.h"
+
+TEST(dynamic_ring_buffer, runtime_size) {
+  disruptor::DynamicRingBuffer<int64_t> ring(1 << 10);
+  EXPECT_EQ(ring.size(), 1 << 10);
+  EXPECT_EQ(ring.index(ring.size() + 3), 3);
+  EXPECT_EQ(&ring.at(5), &ring[ring.size() + 5]);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ring.data()) % 4096, 0);
+  for (int64_t i = 0; i < ring.size(); ++i) EXPECT_EQ(ring[i], 0);
+
+  EXPECT_THROW(disruptor::DynamicRingBuffer<int64_t>(1000),
+               std::runtime_error);
+  EXPECT_THROW(disruptor::DynamicRingBuffer<int64_t>(0), std::runtime_error);
+}
+
+TEST(dynamic_ring_buffer, huge_pages) {
+  disruptor::RingBufferOptions options;
+  options.huge_pages = true;
+
+  // falls back to transparent huge pages when none are reserved
+  disruptor::DynamicRingBuffer<std::string> ring(1 << 16, options);
+  EXPECT_EQ(ring.bytes() % (2 * 1024 * 1024), 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ring.data()) % (2 * 1024 * 1024), 0);
+  ring[7] = "event";
+  EXPECT_EQ(ring.at(ring.size() + 7), "event");
+  LOGGER_DEBUG("ring of %ld strings on %s huge pages", ring.size(),
+               ring.huge_pages() ? "explicit" : "transparent");
+}
+
+TEST(dynamic_ring_buffer, one_producer_one_consumer) {
+  static constexpr int64_t kIterations = 1000 * 1000;
+
+  auto source_data =
+      std::make_shared<disruptor::DynamicRingBuffer<int64_t>>(1 << 12);
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(
+          source_data->size());
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  std::thread producer{[=] {
+    for (int64_t i = 0; i < kIterations; ++i) {
+      auto pos = producer_sequence->next();
+      source_data->at(pos) = pos;
+      producer_sequence->publish(pos);
+    }
+  }};
+
+  auto next_sequence = consumer_sequence->acquire() + 1;
+  while (next_sequence < kIterations) {
+    auto available_sequence = consumer_sequence->wait_for(next_sequence);
+    while (next_sequence <= available_sequence) {
+      ASSERT_EQ(source_data->at(next_sequence), next_sequence);
+      ++next_sequence;
+    }
+    consumer_sequence->publish(available_sequence);
+  }
+  producer.join();
+}
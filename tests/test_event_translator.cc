@@ -0,0 +1,160 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "slog.h"
+
+namespace {
+
+struct Order {
+  std::string symbol;
+  std::vector<int64_t> fills;
+  int64_t pos = -1;
+
+  void clear() {
+    symbol.clear();
+    fills.clear();
+  }
+};
+
+Order make_order() {
+  Order order;
+  order.symbol.reserve(64);
+  order.fills.reserve(8);
+  return order;
+}
+
+void fill(Order& order, int64_t pos, const char* symbol, int64_t fills) {
+  order.symbol.assign(symbol);
+  for (int64_t i = 0; i < fills; ++i) order.fills.push_back(i);
+  order.pos = pos;
+}
+
+struct CheckingHandler {
+  int64_t* handled;
+  void on_event(const Order& order, int64_t pos, bool) {
+    ASSERT_EQ(order.pos, pos);
+    ASSERT_EQ(order.symbol, "a symbol longer than the small string buffer");
+    ASSERT_EQ(order.fills.size(), static_cast<size_t>(pos % 8 + 1));
+    ++*handled;
+  }
+};
+
+/** can only be built by a factory, counts how often it is */
+struct Slot {
+  explicit Slot(int64_t* built) : built(built) { ++*built; }
+  Slot(Slot&& other) noexcept : built(other.built) { ++*built; }
+  ~Slot() { --*built; }
+  Slot& operator=(Slot&&) = delete;
+
+  int64_t* built;
+};
+
+}  // namespace
+
+/** the factory builds every slot in place, no default constructed event
+ *  is overwritten */
+TEST(event_translator, factory_builds_in_place) {
+  int64_t built = 0;
+  {
+    disruptor::RingBuffer<Slot, 16> ring([&] { return Slot(&built); });
+    EXPECT_EQ(built, 16);
+  }
+  EXPECT_EQ(built, 0);
+
+  // a throwing factory leaves nothing behind
+  int64_t calls = 0;
+  EXPECT_THROW((disruptor::RingBuffer<Slot, 16>([&] {
+                 if (++calls == 10) throw std::runtime_error("bad");
+                 return Slot(&built);
+               })),
+               std::runtime_error);
+  EXPECT_EQ(built, 0);
+}
+
+/** steady state publishing reuses the memory the factory reserved */
+TEST(event_translator, reuses_slots) {
+  static constexpr int64_t kSize = 64;
+  static constexpr int64_t kIterations = 100 * 1000;
+
+  auto ring = std::make_shared<disruptor::RingBuffer<Order, kSize>>(make_order);
+  std::vector<const char*> symbols;
+  std::vector<const int64_t*> fills;
+  for (int64_t i = 0; i < kSize; ++i) {
+    symbols.push_back(ring->at(i).symbol.data());
+    fills.push_back(ring->at(i).fills.data());
+  }
+
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  consumer_sequence->follow(producer_sequence);
+  producer_sequence->follow(consumer_sequence);
+
+  int64_t handled = 0;
+  disruptor::BatchOptions options;
+  options.clear_events = true;
+  auto processor = disruptor::make_batch_event_processor(
+      ring, consumer_sequence, CheckingHandler{&handled}, options);
+  std::thread consumer{[&] { processor.run(); }};
+
+  for (int64_t i = 0; i < kIterations; ++i) {
+    auto pos = disruptor::publish_event(
+        *ring, *producer_sequence, fill,
+        "a symbol longer than the small string buffer", i % 8 + 1);
+    ASSERT_EQ(pos, i);
+  }
+  producer_sequence->set_eof();
+  consumer.join();
+
+  EXPECT_EQ(handled, kIterations);
+  for (int64_t i = 0; i < kSize; ++i) {
+    EXPECT_TRUE(ring->at(i).symbol.empty());
+    EXPECT_TRUE(ring->at(i).fills.empty());
+    EXPECT_EQ(ring->at(i).symbol.data(), symbols[i]);
+    EXPECT_EQ(ring->at(i).fills.data(), fills[i]);
+  }
+}
+
+TEST(event_translator, multi_producer) {
+  disruptor::DynamicRingBuffer<Order> ring(8, make_order);
+  EXPECT_GE(ring.at(7).symbol.capacity(), 64u);
+
+  auto producer_sequence =
+      std::make_shared<disruptor::MultiProducerSequencer>(8);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  consumer_sequence->follow(producer_sequence);
+  producer_sequence->follow(consumer_sequence);
+
+  for (int64_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(disruptor::try_publish_event(ring, *producer_sequence, fill,
+                                           "ES", int64_t(1)),
+              i);
+  }
+  EXPECT_EQ(disruptor::try_publish_event(ring, *producer_sequence, fill,
+                                         "ES", int64_t(1)),
+            disruptor::kInsufficientCapacity);
+  EXPECT_EQ(consumer_sequence->try_wait_for(0), 7);
+  EXPECT_EQ(ring.at(5).pos, 5);
+  EXPECT_EQ(ring.at(5).symbol, "ES");
+}
+
+/** a translator that throws still publishes the slot it claimed */
+TEST(event_translator, translator_throws) {
+  disruptor::RingBuffer<Order, 8> ring;
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(8);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  consumer_sequence->follow(producer_sequence);
+
+  EXPECT_THROW(disruptor::publish_event(ring, *producer_sequence,
+                                        [](Order&, int64_t) {
+                                          throw std::runtime_error("bad");
+                                        }),
+               std::runtime_error);
+  EXPECT_EQ(consumer_sequence->try_wait_for(0), 0);
+}
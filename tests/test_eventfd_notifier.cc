@@ -0,0 +1,197 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "slog.h"
+
+namespace {
+
+bool readable(int fd) {
+  struct pollfd p {};
+  p.fd = fd;
+  p.events = POLLIN;
+  return poll(&p, 1, 0) == 1;
+}
+
+}  // namespace
+
+TEST(eventfd_notifier, signals_only_when_parked) {
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(8);
+  disruptor::EventFdNotifier notifier;
+  notifier.attach(*producer_sequence);
+
+  producer_sequence->publish(producer_sequence->next());
+  EXPECT_FALSE(readable(notifier.fd()));
+
+  notifier.park();
+  EXPECT_TRUE(notifier.parked());
+  producer_sequence->publish(producer_sequence->next());
+  EXPECT_TRUE(readable(notifier.fd()));
+  notifier.unpark();
+  EXPECT_FALSE(readable(notifier.fd()));
+
+  producer_sequence->publish(producer_sequence->next());
+  EXPECT_FALSE(readable(notifier.fd()));
+}
+
+/** a notifier gone, or detached, is never signalled again */
+TEST(eventfd_notifier, detach) {
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(8);
+  disruptor::EventFdNotifier notifier;
+  {
+    disruptor::EventFdNotifier gone;
+    gone.attach(*producer_sequence);
+    notifier.attach(*producer_sequence);
+    gone.park();
+  }
+  EXPECT_TRUE(producer_sequence->notify_enabled());
+
+  notifier.park();
+  producer_sequence->publish(producer_sequence->next());
+  EXPECT_TRUE(readable(notifier.fd()));
+  EXPECT_TRUE(notifier.detach(*producer_sequence));
+  EXPECT_FALSE(notifier.detach(*producer_sequence));
+  notifier.unpark();
+  EXPECT_FALSE(producer_sequence->notify_enabled());
+
+  producer_sequence->publish(producer_sequence->next());
+  EXPECT_FALSE(readable(notifier.fd()));
+}
+
+/** attaching to a cursor being published to misses no publish */
+TEST(eventfd_notifier, attach_while_publishing) {
+  static constexpr int64_t kIterations = 20 * 1000;
+
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(64);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  std::thread producer{[&] {
+    for (int64_t i = 0; i < kIterations; ++i)
+      producer_sequence->publish(producer_sequence->next());
+    producer_sequence->set_eof();
+  }};
+
+  // a fresh notifier every round, attached while the producer runs
+  int64_t next_sequence = 0;
+  int parks = 0;
+  while (true) {
+    disruptor::EventFdNotifier notifier;
+    notifier.attach(*producer_sequence);
+    notifier.park();
+    auto available_sequence = consumer_sequence->try_wait_for(next_sequence);
+    if (available_sequence < next_sequence &&
+        available_sequence >= disruptor::Sequence::INIT_SEQUENCE) {
+      ++parks;
+      struct pollfd p {};
+      p.fd = notifier.fd();
+      p.events = POLLIN;
+      ASSERT_EQ(poll(&p, 1, 10 * 1000), 1) << "missed " << next_sequence;
+      available_sequence = consumer_sequence->try_wait_for(next_sequence);
+    }
+    notifier.unpark();
+    if (available_sequence == disruptor::kEof) break;
+    if (available_sequence < next_sequence) continue;
+    consumer_sequence->publish(available_sequence);
+    next_sequence = available_sequence + 1;
+  }
+  producer.join();
+  EXPECT_EQ(next_sequence, kIterations);
+  LOGGER_DEBUG("consumer parked %d times", parks);
+}
+
+/** listeners are process local, a shared cursor can not take one */
+TEST(eventfd_notifier, rejects_process_shared) {
+  disruptor::Sequence shared(true);
+  disruptor::EventFdNotifier notifier;
+  EXPECT_THROW(notifier.attach(shared), std::logic_error);
+  EXPECT_FALSE(shared.notify_enabled());
+}
+
+/** a consumer serving a socket and the queue from a single epoll loop */
+TEST(eventfd_notifier, epoll_loop) {
+  static constexpr int64_t kSize = 64;
+  static constexpr int64_t kIterations = 10 * 1000;
+  static constexpr int kBursts = 20;
+
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  disruptor::EventFdNotifier notifier;
+  notifier.attach(*producer_sequence);
+
+  int pipe_fds[2];
+  ASSERT_EQ(pipe(pipe_fds), 0);
+  auto epfd = epoll_create1(EPOLL_CLOEXEC);
+  ASSERT_GE(epfd, 0);
+  for (auto fd : {notifier.fd(), pipe_fds[0]}) {
+    struct epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    ASSERT_EQ(epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event), 0);
+  }
+
+  // bursts separated by pauses, so the consumer parks in between
+  std::thread producer{[&] {
+    for (int b = 0; b < kBursts; ++b) {
+      for (int64_t i = 0; i < kIterations / kBursts; ++i) {
+        auto pos = producer_sequence->next();
+        source_data->at(pos) = pos;
+        producer_sequence->publish(pos);
+      }
+      char message = 'm';
+      ASSERT_EQ(write(pipe_fds[1], &message, 1), 1);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }};
+
+  int parks = 0;
+  int messages = 0;
+  auto next_sequence = consumer_sequence->acquire() + 1;
+  while (next_sequence < kIterations || messages < kBursts) {
+    auto available_sequence = consumer_sequence->try_wait_for(next_sequence);
+    if (available_sequence < next_sequence) {
+      notifier.park();
+      available_sequence = consumer_sequence->try_wait_for(next_sequence);
+      struct epoll_event events[2];
+      auto n = available_sequence < next_sequence
+                   ? epoll_wait(epfd, events, 2, 1000)
+                   : epoll_wait(epfd, events, 2, 0);
+      notifier.unpark();
+      ++parks;
+      for (int i = 0; i < n; ++i) {
+        if (events[i].data.fd != pipe_fds[0]) continue;
+        char buffer[kBursts];
+        messages += read(pipe_fds[0], buffer, sizeof(buffer));
+      }
+      continue;
+    }
+    for (; next_sequence <= available_sequence; ++next_sequence) {
+      ASSERT_EQ(source_data->at(next_sequence), next_sequence);
+    }
+    consumer_sequence->publish(available_sequence);
+  }
+  producer.join();
+
+  EXPECT_EQ(next_sequence, kIterations);
+  EXPECT_EQ(messages, kBursts);
+  EXPECT_GE(parks, 1);
+  LOGGER_DEBUG("consumer parked %d times over %d bursts", parks, kBursts);
+  close(epfd);
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
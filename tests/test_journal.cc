@@ -0,0 +1,299 @@
+#include <dirent.h>
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "slog.h"
+
+namespace {
+
+struct Trade {
+  int64_t pos;
+  int64_t price;
+  int32_t quantity;
+};
+
+Trade make_trade(int64_t i) { return Trade{i, 100 + i % 7, int32_t(i % 13)}; }
+
+/** a fresh directory under /tmp, removed with everything in it */
+class TempDirectory {
+ public:
+  TempDirectory() {
+    char path[] = "/tmp/journal_XXXXXX";
+    path_ = mkdtemp(path);
+  }
+  ~TempDirectory() {
+    if (auto dir = opendir(path_.c_str())) {
+      while (auto entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") unlink((path_ + "/" + name).c_str());
+      }
+      closedir(dir);
+    }
+    rmdir(path_.c_str());
+  }
+
+  const std::string& path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
+int count_segments(const std::string& path) {
+  int segments = 0;
+  if (auto dir = opendir(path.c_str())) {
+    while (auto entry = readdir(dir)) {
+      if (std::string(entry->d_name).find(".journal") != std::string::npos)
+        ++segments;
+    }
+    closedir(dir);
+  }
+  return segments;
+}
+
+void check_replay(const std::string& path, int64_t events) {
+  disruptor::JournalReader<Trade> reader(path);
+  int64_t replayed = 0;
+  auto end = reader.replay([&](const Trade& trade, int64_t index) {
+    ASSERT_EQ(index, replayed);
+    ASSERT_EQ(trade.pos, index);
+    ASSERT_EQ(trade.price, make_trade(index).price);
+    ++replayed;
+  });
+  EXPECT_EQ(end, events);
+  EXPECT_EQ(replayed, events);
+}
+
+/** checks every position published against what the journal synced */
+struct CheckedConsumer : disruptor::ConsumerSequencer {
+  const disruptor::JournalWriter<Trade>* journal = nullptr;
+  int64_t publishes = 0;
+
+  void publish(int64_t pos) {
+    ASSERT_GT(journal->synced_index(), pos);
+    ++publishes;
+    disruptor::ConsumerSequencer::publish(pos);
+  }
+};
+
+}  // namespace
+
+/** the journal as a gating stage, then replayed into a fresh ring */
+TEST(journal, pipeline) {
+  static constexpr int64_t kSize = 256;
+  static constexpr int64_t kIterations = 10 * 1000;
+  TempDirectory directory;
+
+  disruptor::JournalOptions options;
+  options.segment_bytes = 4096;
+  options.sync = disruptor::JournalOptions::kAsync;
+
+  auto ring = std::make_shared<disruptor::RingBuffer<Trade, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  auto journal_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  auto downstream_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  journal_sequence->follow(producer_sequence);
+  downstream_sequence->follow(journal_sequence);
+  producer_sequence->follow(downstream_sequence);
+
+  auto journal = disruptor::make_batch_event_processor(
+      ring, journal_sequence,
+      disruptor::JournalWriter<Trade>(directory.path(), options));
+  std::thread journal_thread{[&] { journal.run(); }};
+  std::thread downstream{[&] {
+    auto next_sequence = downstream_sequence->acquire() + 1;
+    while (true) {
+      auto available_sequence = downstream_sequence->wait_for(next_sequence);
+      if (available_sequence < next_sequence) break;
+      // everything downstream sees is already journaled
+      ASSERT_GE(journal.consumer()->acquire(), available_sequence);
+      next_sequence = available_sequence + 1;
+      downstream_sequence->publish(available_sequence);
+    }
+  }};
+
+  for (int64_t i = 0; i < kIterations; ++i) {
+    auto pos = producer_sequence->next();
+    ring->at(pos) = make_trade(pos);
+    producer_sequence->publish(pos);
+  }
+  producer_sequence->set_eof();
+  journal_thread.join();
+  downstream.join();
+
+  EXPECT_EQ(journal.handler().next_index(), kIterations);
+  EXPECT_GT(count_segments(directory.path()), 1);
+  check_replay(directory.path(), kIterations);
+
+  // startup: the journal rebuilds a fresh ring
+  auto fresh = std::make_shared<disruptor::RingBuffer<Trade, kSize>>();
+  auto replay_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  consumer_sequence->follow(replay_sequence);
+  replay_sequence->follow(consumer_sequence);
+
+  int64_t consumed = 0;
+  std::thread consumer{[&] {
+    auto next_sequence = consumer_sequence->acquire() + 1;
+    while (true) {
+      auto available_sequence = consumer_sequence->wait_for(next_sequence);
+      if (available_sequence < next_sequence) break;
+      for (; next_sequence <= available_sequence; ++next_sequence) {
+        ASSERT_EQ(fresh->at(next_sequence).pos, next_sequence);
+        ++consumed;
+      }
+      consumer_sequence->publish(available_sequence);
+    }
+  }};
+  disruptor::JournalReader<Trade> reader(directory.path());
+  EXPECT_EQ(reader.replay_into(*fresh, *replay_sequence), kIterations - 1);
+  replay_sequence->set_eof();
+  consumer.join();
+  EXPECT_EQ(consumed, kIterations);
+}
+
+/** progress published within a batch is synced first */
+TEST(journal, publish_interval) {
+  static constexpr int64_t kSize = 256;
+  TempDirectory directory;
+  disruptor::JournalOptions options;
+  options.segment_bytes = 4096;
+  options.sync = disruptor::JournalOptions::kMsync;
+
+  auto ring = std::make_shared<disruptor::RingBuffer<Trade, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  auto journal_sequence = std::make_shared<CheckedConsumer>();
+  journal_sequence->follow(producer_sequence);
+  producer_sequence->follow(journal_sequence);
+
+  disruptor::BatchOptions batch;
+  batch.publish_interval = 8;
+  auto journal = disruptor::make_batch_event_processor(
+      ring, journal_sequence,
+      disruptor::JournalWriter<Trade>(directory.path(), options), batch);
+  journal_sequence->journal = &journal.handler();
+
+  auto end = producer_sequence->next(100);
+  for (int64_t pos = 0; pos <= end; ++pos) ring->at(pos) = make_trade(pos);
+  producer_sequence->publish(end);
+  EXPECT_EQ(journal.process_batch(), 100);
+  EXPECT_EQ(journal_sequence->publishes, 13);
+  EXPECT_EQ(journal.handler().synced_index(), 100);
+  check_replay(directory.path(), 100);
+}
+
+/** a writer reopening a journal continues after its last intact record */
+TEST(journal, recover) {
+  TempDirectory directory;
+  disruptor::JournalOptions options;
+  options.segment_bytes = 4096;
+  options.sync = disruptor::JournalOptions::kMsync;
+
+  {
+    disruptor::JournalWriter<Trade> writer(directory.path(), options);
+    for (int64_t i = 0; i < 300; ++i) writer.append(make_trade(i));
+    writer.sync();
+  }
+  check_replay(directory.path(), 300);
+
+  // tears record 290, in the last of three segments
+  static constexpr long kRecordBytes = (16 + sizeof(Trade) + 7) / 8 * 8;
+  static constexpr long kPerSegment = (4096 - 64) / kRecordBytes;
+  ASSERT_EQ(count_segments(directory.path()), 3);
+  char segment[64];
+  std::snprintf(segment, sizeof(segment), "/%020ld.journal", 2 * kPerSegment);
+  auto file = std::fopen((directory.path() + segment).c_str(), "r+b");
+  ASSERT_NE(file, nullptr);
+  std::fseek(file, 64 + (290 - 2 * kPerSegment) * kRecordBytes + 20,
+             SEEK_SET);
+  std::fputc(0x5a, file);
+  std::fclose(file);
+  check_replay(directory.path(), 290);
+
+  {
+    disruptor::JournalWriter<Trade> writer(directory.path(), options);
+    EXPECT_EQ(writer.next_index(), 290);
+    for (int64_t i = 290; i < 295; ++i) writer.append(make_trade(i));
+    writer.sync();
+  }
+  // 295 to 299 were left over from before and are not replayed
+  check_replay(directory.path(), 295);
+}
+
+/** a crash between creating the last segment and preallocating it */
+TEST(journal, truncated_last_segment) {
+  TempDirectory directory;
+  disruptor::JournalOptions options;
+  options.segment_bytes = 4096;
+  options.sync = disruptor::JournalOptions::kMsync;
+
+  {
+    disruptor::JournalWriter<Trade> writer(directory.path(), options);
+    for (int64_t i = 0; i < 300; ++i) writer.append(make_trade(i));
+    writer.sync();
+  }
+
+  static constexpr long kRecordBytes = (16 + sizeof(Trade) + 7) / 8 * 8;
+  static constexpr long kPerSegment = (4096 - 64) / kRecordBytes;
+  ASSERT_EQ(count_segments(directory.path()), 3);
+  char segment[64];
+  std::snprintf(segment, sizeof(segment), "/%020ld.journal", 2 * kPerSegment);
+  auto path = directory.path() + segment;
+
+  for (off_t bytes : {0, 32}) {
+    ASSERT_EQ(truncate(path.c_str(), bytes), 0);
+    check_replay(directory.path(), 2 * kPerSegment);
+    // skipping ahead into the truncated segment replays nothing
+    disruptor::JournalReader<Trade> reader(directory.path());
+    int64_t replayed = 0;
+    EXPECT_EQ(reader.replay([&](const Trade&, int64_t) { ++replayed; },
+                            2 * kPerSegment + 1),
+              2 * kPerSegment);
+    EXPECT_EQ(replayed, 0);
+
+    {
+      disruptor::JournalWriter<Trade> writer(directory.path(), options);
+      EXPECT_EQ(writer.next_index(), 2 * kPerSegment);
+      for (int64_t i = 2 * kPerSegment; i < 300; ++i)
+        writer.append(make_trade(i));
+      writer.sync();
+    }
+    EXPECT_EQ(count_segments(directory.path()), 3);
+    check_replay(directory.path(), 300);
+  }
+}
+
+/** fdatasync every batch and skip ahead in replay */
+TEST(journal, fdatasync) {
+  TempDirectory directory;
+  disruptor::JournalOptions options;
+  options.segment_bytes = 4096;
+  options.sync = disruptor::JournalOptions::kFdatasync;
+
+  disruptor::JournalWriter<Trade> writer(directory.path(), options);
+  for (int64_t i = 0; i < 500; ++i)
+    writer.on_event(make_trade(i), i, i % 50 == 49);
+  EXPECT_EQ(writer.next_index(), 500);
+
+  disruptor::JournalReader<Trade> reader(directory.path());
+  int64_t first = -1;
+  int64_t replayed = 0;
+  EXPECT_EQ(reader.replay(
+                [&](const Trade& trade, int64_t index) {
+                  if (first < 0) first = index;
+                  EXPECT_EQ(trade.pos, index);
+                  ++replayed;
+                },
+                400),
+            500);
+  EXPECT_EQ(first, 400);
+  EXPECT_EQ(replayed, 100);
+}
@@ -29,36 +29,29 @@ TEST(queue, three_producer_three_consumer) {
 
   auto produce_thread_entry =
       [=](std::shared_ptr<disruptor::MultiProducerSequencer> producer) {
-        try {
-          for (int64_t i = 0; i < kIterations; ++i) {
-            auto pos = producer->next();
-            source_data->at(pos) = pos;
-            producer->publish_after(pos, pos - 1);
-          }
-          producer->set_eof();
-        } catch (std::exception& e) {
-          LOGGER_WARN("producer caught: %s, at pos %ld", e.what(),
-                      producer->acquire());
+        for (int64_t i = 0; i < kIterations; ++i) {
+          auto pos = producer->next();
+          if (pos < 0) break;  // another producer ended the stream
+          source_data->at(pos) = pos;
+          if (!producer->publish_after(pos, pos - 1)) break;
         }
+        producer->set_eof();
       };
 
   auto consume_thread_entry =
       [=](std::shared_ptr<disruptor::ConsumerSequencer> consumer) {
-        try {
-          auto next_sequence = consumer->acquire() + 1;
-          ASSERT_EQ(next_sequence, 0);
-          while (true) {
-            auto available_sequence = consumer->wait_for(next_sequence);
-            while (next_sequence <= available_sequence) {
-              ASSERT_EQ(source_data->at(next_sequence), next_sequence);
-              ++next_sequence;
-            }
-            consumer->publish(available_sequence);
+        auto next_sequence = consumer->acquire() + 1;
+        ASSERT_EQ(next_sequence, 0);
+        while (true) {
+          auto available_sequence = consumer->wait_for(next_sequence);
+          if (available_sequence < next_sequence) break;
+          while (next_sequence <= available_sequence) {
+            ASSERT_EQ(source_data->at(next_sequence), next_sequence);
+            ++next_sequence;
           }
-        } catch (std::exception& e) {
-          LOGGER_WARN("consumer caught: %s, at pos %ld", e.what(),
-                      consumer->acquire());
+          consumer->publish(available_sequence);
         }
+        LOGGER_DEBUG("consumer reached eof at pos %ld", consumer->acquire());
       };
 
   struct timespec start_tp {};
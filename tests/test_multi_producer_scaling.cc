@@ -0,0 +1,143 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include "slog.h"
+
+namespace {
+
+/**
+ *  The previous MultiProducerSequencer: a producer may only publish after
+ *  every earlier claim has been published, so producers wait on each other.
+ */
+class SerializedMultiProducerSequencer : public disruptor::EventCursor {
+ private:
+  using EventCursor::publish;
+
+ public:
+  explicit SerializedMultiProducerSequencer(int64_t s) : size_(s) {}
+
+  int64_t next(int64_t num_slots = 1) {
+    auto next_sequence = claim_cursor_.increment_and_get(num_slots);
+    auto wrap_point = next_sequence - size_;
+    int64_t min_sequence =
+        cached_min_sequence_.load(std::memory_order_relaxed);
+    if (wrap_point >= min_sequence) {
+      while (!eof() &&
+             wrap_point >= (min_sequence = barrier_.get_min(wrap_point))) {
+        std::this_thread::yield();
+      }
+      cached_min_sequence_.store(min_sequence, std::memory_order_relaxed);
+    }
+    if (eof()) return disruptor::kEof;
+    return next_sequence;
+  }
+
+  bool publish_after(int64_t pos, int64_t after_pos) {
+    while (!eof() && after_pos > acquire()) {
+    }
+    if (eof()) return false;
+    publish(pos);
+    return true;
+  }
+
+ private:
+  const int64_t size_;
+  disruptor::Sequence claim_cursor_;
+  alignas(disruptor::kCacheLineSize) std::atomic<int64_t> cached_min_sequence_{
+      disruptor::Sequence::INIT_SEQUENCE};
+};
+
+double now() {
+  struct timespec tp {};
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return (double)(tp.tv_sec) + (double)tp.tv_nsec / 1000 / 1000 / 1000;
+}
+
+/** N producers - 1 consumer, @return M ops/secs */
+template <typename Sequencer>
+double multi_producer_throughput(int produce_thread_num,
+                                 int64_t iterations_per_producer) {
+  static constexpr int64_t kSize = 1024;
+
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, kSize>>();
+  auto producer_sequence = std::make_shared<Sequencer>(source_data->size());
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  const int64_t total = produce_thread_num * iterations_per_producer;
+  auto start = now();
+
+  std::vector<std::thread> produce_threads;
+  for (int i = 0; i < produce_thread_num; ++i) {
+    produce_threads.emplace_back([=] {
+      for (int64_t n = 0; n < iterations_per_producer; ++n) {
+        auto pos = producer_sequence->next();
+        source_data->at(pos) = pos;
+        producer_sequence->publish_after(pos, pos - 1);
+      }
+    });
+  }
+
+  auto next_sequence = consumer_sequence->acquire() + 1;
+  while (next_sequence < total) {
+    auto available_sequence = consumer_sequence->wait_for(next_sequence);
+    while (next_sequence <= available_sequence) {
+      EXPECT_EQ(source_data->at(next_sequence), next_sequence);
+      ++next_sequence;
+    }
+    consumer_sequence->publish(available_sequence);
+  }
+  for (auto& p : produce_threads) p.join();
+
+  return total / (now() - start) / 1000.0 / 1000.0;
+}
+
+}  // namespace
+
+TEST(multi_producer, scaling) {
+  static constexpr int64_t kIterations = 100 * 1000;
+
+  auto cores = static_cast<int>(std::thread::hardware_concurrency());
+  for (int producers = 1; producers <= std::max(4, cores); producers *= 2) {
+    // with more producers than cores the serialized version spins away
+    // whole time slices waiting for descheduled producers, don't bother
+    auto serialized =
+        producers > cores
+            ? 0.0
+            : multi_producer_throughput<SerializedMultiProducerSequencer>(
+                  producers, kIterations / producers);
+    auto independent =
+        multi_producer_throughput<disruptor::MultiProducerSequencer>(
+            producers, kIterations / producers);
+    LOGGER_DEBUG("%d producer - 1 consumer performance: serialized %f, "
+                 "availability buffer %f M ops/secs",
+                 producers, serialized, independent);
+  }
+}
+
+TEST(multi_producer, out_of_order_publish) {
+  auto producer_sequence =
+      std::make_shared<disruptor::MultiProducerSequencer>(8);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  auto first = producer_sequence->next(2);
+  auto second = producer_sequence->next(3);
+  EXPECT_EQ(first, 1);
+  EXPECT_EQ(second, 4);
+
+  // the later claim is published first, followers must not see it yet
+  producer_sequence->publish_after(second, first);
+  EXPECT_FALSE(producer_sequence->availability()->is_available(0));
+  EXPECT_TRUE(producer_sequence->availability()->is_available(2));
+
+  producer_sequence->publish_after(first, first - 2);
+  EXPECT_EQ(consumer_sequence->wait_for(0), second);
+}
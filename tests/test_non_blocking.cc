@@ -0,0 +1,124 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "slog.h"
+
+static constexpr auto kProduceThreadNum = 3;
+
+namespace {
+
+void publish(disruptor::SingleProducerSequencer& producer, int64_t pos,
+             int64_t) {
+  producer.publish(pos);
+}
+
+void publish(disruptor::MultiProducerSequencer& producer, int64_t pos,
+             int64_t num) {
+  producer.publish_after(pos, pos - num);
+}
+
+template <typename Sequencer>
+void check_capacity() {
+  auto producer_sequence = std::make_shared<Sequencer>(8);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  EXPECT_EQ(producer_sequence->remaining_capacity(), 8);
+  EXPECT_EQ(producer_sequence->consumer_lag(), 0);
+  EXPECT_LT(consumer_sequence->try_wait_for(0), 0);
+
+  auto end = producer_sequence->try_next(8);
+  EXPECT_EQ(end, 7);
+  publish(*producer_sequence, end, 8);
+  EXPECT_LT(producer_sequence->try_next(), 0);
+  EXPECT_EQ(producer_sequence->remaining_capacity(), 0);
+  EXPECT_EQ(producer_sequence->consumer_lag(), 8);
+
+  EXPECT_EQ(consumer_sequence->try_wait_for(0), 7);
+  consumer_sequence->publish(3);
+  EXPECT_EQ(producer_sequence->remaining_capacity(), 4);
+  EXPECT_EQ(producer_sequence->consumer_lag(), 4);
+  EXPECT_LT(producer_sequence->try_next(5), 0);
+  EXPECT_EQ(producer_sequence->try_next(4), 11);
+  EXPECT_EQ(producer_sequence->remaining_capacity(), 0);
+}
+
+}  // namespace
+
+TEST(non_blocking, single_producer_capacity) {
+  check_capacity<disruptor::SingleProducerSequencer>();
+}
+
+TEST(non_blocking, multi_producer_capacity) {
+  check_capacity<disruptor::MultiProducerSequencer>();
+}
+
+TEST(non_blocking, consumer_eof) {
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(8);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  consumer_sequence->follow(producer_sequence);
+
+  producer_sequence->set_eof();
+  EXPECT_EQ(consumer_sequence->try_wait_for(0), disruptor::kEof);
+  EXPECT_TRUE(consumer_sequence->eof());
+}
+
+/** producers shed load instead of waiting when the ring is full */
+TEST(non_blocking, multi_producer_try_next) {
+  static constexpr int64_t kSize = 64;
+  static constexpr int64_t kIterations = 100 * 1000;
+  const int64_t total = kIterations * kProduceThreadNum;
+
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::MultiProducerSequencer>(kSize);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  std::atomic<int64_t> full{0};
+  std::array<std::thread, kProduceThreadNum> produce_threads;
+  for (auto& p : produce_threads) {
+    p = std::thread{[&] {
+      for (int64_t n = 0; n < kIterations;) {
+        auto pos = producer_sequence->try_next();
+        if (pos < 0) {
+          // a reactor would go back to its other sockets here
+          full.fetch_add(1, std::memory_order_relaxed);
+          std::this_thread::yield();
+          continue;
+        }
+        source_data->at(pos) = pos;
+        producer_sequence->publish_after(pos, pos - 1);
+        ++n;
+      }
+    }};
+  }
+
+  std::vector<bool> seen(total);
+  auto next_sequence = consumer_sequence->acquire() + 1;
+  while (next_sequence < total) {
+    auto available_sequence = consumer_sequence->try_wait_for(next_sequence);
+    if (available_sequence < next_sequence) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (; next_sequence <= available_sequence; ++next_sequence) {
+      ASSERT_EQ(source_data->at(next_sequence), next_sequence);
+      seen[next_sequence] = true;
+    }
+    consumer_sequence->publish(available_sequence);
+  }
+  for (auto& p : produce_threads) p.join();
+
+  for (int64_t pos = 0; pos < total; ++pos) ASSERT_TRUE(seen[pos]);
+  EXPECT_EQ(producer_sequence->consumer_lag(), 0);
+  LOGGER_DEBUG("ring full on %ld of %ld claims", full.load(), total);
+}
@@ -0,0 +1,133 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include "slog.h"
+
+static constexpr auto kConsumeThreadNum = 3;
+
+namespace {
+
+double now() {
+  struct timespec tp {};
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return (double)(tp.tv_sec) + (double)tp.tv_nsec / 1000 / 1000 / 1000;
+}
+
+void publish(disruptor::SingleProducerSequencer& producer, int64_t pos) {
+  producer.publish(pos);
+}
+
+void publish(disruptor::MultiProducerSequencer& producer, int64_t pos) {
+  producer.publish_after(pos, pos - 1);
+}
+
+/**
+ *  Places the ring and every cursor on memory_node and runs all threads on
+ *  the cpus of cpu_node.
+ *
+ *  @return M ops/secs
+ */
+template <typename Sequencer>
+double placed_throughput(int produce_thread_num, int memory_node,
+                         int cpu_node) {
+  static constexpr int64_t kSize = 1024;
+  const int64_t iterations = 1000 * 1000 / produce_thread_num;
+  const int64_t total = iterations * produce_thread_num;
+
+  disruptor::RingBufferOptions options;
+  options.numa_node = memory_node;
+  auto source_data =
+      std::make_shared<disruptor::DynamicRingBuffer<int64_t>>(kSize, options);
+  auto producer_sequence = disruptor::make_shared_on_numa_node<Sequencer>(
+      memory_node, source_data->size());
+  std::vector<std::shared_ptr<disruptor::ConsumerSequencer>> consumers;
+  for (auto i = 0; i < kConsumeThreadNum; i++) {
+    consumers.push_back(
+        disruptor::make_shared_on_numa_node<disruptor::ConsumerSequencer>(
+            memory_node));
+    producer_sequence->follow(consumers.back());
+    consumers.back()->follow(producer_sequence);
+  }
+
+  auto start = now();
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < produce_thread_num; i++) {
+    threads.emplace_back([=] {
+      disruptor::pin_current_thread_to_numa_node(cpu_node);
+      for (int64_t n = 0; n < iterations; ++n) {
+        auto pos = producer_sequence->next();
+        source_data->at(pos) = pos;
+        publish(*producer_sequence, pos);
+      }
+    });
+  }
+  for (auto& consumer : consumers) {
+    threads.emplace_back([=] {
+      disruptor::pin_current_thread_to_numa_node(cpu_node);
+      auto next_sequence = consumer->acquire() + 1;
+      while (next_sequence < total) {
+        auto available_sequence = consumer->wait_for(next_sequence);
+        while (next_sequence <= available_sequence) {
+          EXPECT_EQ(source_data->at(next_sequence), next_sequence);
+          ++next_sequence;
+        }
+        consumer->publish(available_sequence);
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+
+  return total / (now() - start) / 1000.0 / 1000.0;
+}
+
+template <typename Sequencer>
+void report_placement(const char* topology, int produce_thread_num) {
+  auto same_node = placed_throughput<Sequencer>(produce_thread_num, 0, 0);
+  if (disruptor::numa_node_count() < 2) {
+    LOGGER_DEBUG("%s same node %f M ops/secs, single node machine", topology,
+                 same_node);
+    return;
+  }
+  auto cross_node = placed_throughput<Sequencer>(produce_thread_num, 1, 0);
+  LOGGER_DEBUG("%s same node %f, cross node %f M ops/secs", topology,
+               same_node, cross_node);
+}
+
+}  // namespace
+
+TEST(numa_placement, node_cpus) {
+  ASSERT_GE(disruptor::numa_node_count(), 1);
+  EXPECT_FALSE(disruptor::numa_node_cpus(0).empty());
+}
+
+/** the availability words move along with a multi producer cursor */
+TEST(numa_placement, availability_buffer) {
+  auto producer_sequence =
+      disruptor::make_shared_on_numa_node<disruptor::MultiProducerSequencer>(
+          0, 8);
+  auto available = producer_sequence->availability();
+  ASSERT_NE(available, nullptr);
+  EXPECT_EQ(available->size(), 8);
+
+  auto a = producer_sequence->next(2);
+  auto b = producer_sequence->next(2);
+  producer_sequence->publish_after(b, b - 2);
+  EXPECT_FALSE(available->is_available(a));
+  EXPECT_TRUE(available->is_available(b));
+  producer_sequence->publish_after(a, a - 2);
+  EXPECT_EQ(available->highest_published(0, b), b);
+}
+
+TEST(numa_placement, one_producer_multi_consumer) {
+  report_placement<disruptor::SingleProducerSequencer>(
+      "1 producer - 3 consumer", 1);
+}
+
+TEST(numa_placement, three_producer_three_consumer) {
+  report_placement<disruptor::MultiProducerSequencer>(
+      "3 producer - 3 consumer", 3);
+}
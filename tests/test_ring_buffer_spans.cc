@@ -0,0 +1,88 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+TEST(ring_buffer, spans) {
+  disruptor::RingBuffer<int64_t, 8> ring;
+
+  auto inside = ring.spans(2, 4);
+  EXPECT_EQ(inside.first.data, &ring.at(2));
+  EXPECT_EQ(inside.first.size, 4);
+  EXPECT_TRUE(inside.second.empty());
+
+  auto wrapped = ring.spans(8 + 6, 5);
+  EXPECT_EQ(wrapped.first.data, &ring.at(6));
+  EXPECT_EQ(wrapped.first.size, 2);
+  EXPECT_EQ(wrapped.second.data, &ring.at(0));
+  EXPECT_EQ(wrapped.second.size, 3);
+  EXPECT_EQ(wrapped.size(), 5);
+
+  auto whole = ring.spans(3, ring.size());
+  EXPECT_EQ(whole.size(), ring.size());
+
+  disruptor::DynamicRingBuffer<int64_t> dynamic_ring(8);
+  EXPECT_EQ(dynamic_ring.spans(6, 4).second.size, 2);
+}
+
+TEST(ring_buffer, bulk_byte_stream) {
+  static constexpr int64_t kSize = 64;
+  static constexpr int64_t kChunk = 24;
+  static constexpr int64_t kChunks = 1000;
+
+  auto ring = std::make_shared<disruptor::RingBuffer<char, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(ring->size());
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  std::string sent;
+  for (int64_t i = 0; i < kChunk * kChunks; ++i) sent.push_back('a' + i % 26);
+
+  int pipe_fds[2];
+  ASSERT_EQ(pipe(pipe_fds), 0);
+
+  // memcpy straight into the ring
+  std::thread producer{[&] {
+    for (int64_t chunk = 0; chunk < kChunks; ++chunk) {
+      auto end = producer_sequence->next(kChunk);
+      auto spans = ring->spans(end - kChunk + 1, kChunk);
+      auto src = sent.data() + chunk * kChunk;
+      memcpy(spans.first.data, src, spans.first.bytes());
+      memcpy(spans.second.data, src + spans.first.size, spans.second.bytes());
+      producer_sequence->publish(end);
+    }
+  }};
+
+  // writev straight out of the ring
+  std::string received;
+  std::thread consumer{[&] {
+    auto next_sequence = consumer_sequence->acquire() + 1;
+    while (next_sequence < kChunk * kChunks) {
+      auto available_sequence = consumer_sequence->wait_for(next_sequence);
+      auto spans =
+          ring->spans(next_sequence, available_sequence - next_sequence + 1);
+      struct iovec iov[2];
+      auto written = writev(pipe_fds[1], iov, spans.to_iovec(iov));
+      ASSERT_EQ(written, spans.bytes());
+
+      char buffer[kSize];
+      ASSERT_EQ(read(pipe_fds[0], buffer, written), written);
+      received.append(buffer, written);
+
+      next_sequence = available_sequence + 1;
+      consumer_sequence->publish(available_sequence);
+    }
+  }};
+
+  producer.join();
+  consumer.join();
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+  EXPECT_EQ(received, sent);
+}
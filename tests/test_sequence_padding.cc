@@ -0,0 +1,99 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <ctime>
+#include <thread>
+
+#include "slog.h"
+
+static constexpr auto kProduceThreadNum = 3;
+static constexpr auto kConsumeThreadNum = 3;
+
+namespace {
+
+// The layout Sequence had before padding: the cursor and its eof flag packed
+// next to whatever the owner allocates after it.
+struct PackedSequence {
+  std::atomic<int64_t> sequence{-1};
+  volatile bool alert{false};
+};
+
+double now() {
+  struct timespec tp {};
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return (double)(tp.tv_sec) + (double)tp.tv_nsec / 1000 / 1000 / 1000;
+}
+
+/**
+ *  Same shape as the 3 producer / 3 consumer queue test: every producer
+ *  publishes its own cursor while every consumer polls all of them.
+ */
+template <typename CursorType, typename Store, typename Load>
+double cursor_throughput(Store store, Load load) {
+  static constexpr int64_t kIterations = 1000 * 1000;
+
+  std::array<CursorType, kProduceThreadNum> cursors{};
+  std::atomic<int> running{kProduceThreadNum};
+
+  std::array<std::thread, kProduceThreadNum> produce_threads;
+  std::array<std::thread, kConsumeThreadNum> consume_threads;
+
+  auto start = now();
+  for (auto i = 0; i < kProduceThreadNum; i++) {
+    produce_threads[i] = std::thread{[&, i] {
+      for (int64_t pos = 0; pos < kIterations; ++pos) store(cursors[i], pos);
+      running.fetch_sub(1);
+    }};
+  }
+  for (auto& c : consume_threads) {
+    c = std::thread{[&] {
+      int64_t sum = 0;
+      while (running.load() != 0) {
+        for (auto& cursor : cursors) sum += load(cursor);
+      }
+      EXPECT_GE(sum, 0);
+    }};
+  }
+
+  for (auto& p : produce_threads) p.join();
+  for (auto& c : consume_threads) c.join();
+  auto end = now();
+
+  return kProduceThreadNum * kIterations / (end - start) / 1000.0 / 1000.0;
+}
+
+}  // namespace
+
+TEST(sequence, padded_layout) {
+  EXPECT_EQ(alignof(disruptor::Sequence), disruptor::kCacheLineSize);
+  EXPECT_EQ(sizeof(disruptor::Sequence) % disruptor::kCacheLineSize, 0);
+
+  std::array<disruptor::Sequence, 2> sequences;
+  auto distance = reinterpret_cast<uintptr_t>(&sequences[1]) -
+                  reinterpret_cast<uintptr_t>(&sequences[0]);
+  EXPECT_GE(distance, disruptor::kCacheLineSize);
+
+  auto producer = std::make_shared<disruptor::MultiProducerSequencer>(1024);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(producer.get()) %
+                disruptor::kCacheLineSize,
+            0);
+}
+
+TEST(sequence, false_sharing_three_producer_three_consumer) {
+  auto packed = cursor_throughput<PackedSequence>(
+      [](PackedSequence& s, int64_t pos) {
+        s.sequence.store(pos, std::memory_order_release);
+      },
+      [](const PackedSequence& s) {
+        return s.sequence.load(std::memory_order_acquire);
+      });
+
+  auto padded = cursor_throughput<disruptor::Sequence>(
+      [](disruptor::Sequence& s, int64_t pos) { s.store(pos); },
+      [](const disruptor::Sequence& s) { return s.acquire(); });
+
+  LOGGER_DEBUG("%d producer - %d consumer cursor publish: packed %f, padded %f "
+               "M ops/secs",
+               kProduceThreadNum, kConsumeThreadNum, packed, padded);
+}
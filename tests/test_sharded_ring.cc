@@ -0,0 +1,144 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "slog.h"
+
+namespace {
+
+struct Tick {
+  int64_t key;
+  int64_t seq;
+};
+
+void translate(Tick& tick, int64_t, int64_t key, int64_t seq) {
+  tick.key = key;
+  tick.seq = seq;
+}
+
+}  // namespace
+
+/** producers routed by key, every key arrives in order */
+TEST(sharded_ring, key_order) {
+  static constexpr int kProducers = 4;
+  static constexpr int64_t kKeys = 64;
+  static constexpr int64_t kPerKey = 2000;
+
+  disruptor::ShardedRing<Tick> ticks(4, 256);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      // every producer owns the keys k with k % kProducers == p
+      for (int64_t seq = 0; seq < kPerKey; ++seq) {
+        for (int64_t key = p; key < kKeys; key += kProducers) {
+          ASSERT_GE(ticks.publish_event(ticks.shard_for(key), translate, key,
+                                        seq),
+                    0);
+        }
+      }
+    });
+  }
+
+  std::vector<int64_t> next_seq(kKeys, 0);
+  std::vector<int64_t> per_shard(ticks.shard_count(), 0);
+  int64_t consumed = 0;
+  std::thread consumer{[&] {
+    while (true) {
+      auto processed =
+          ticks.poll([&](const Tick& tick, size_t shard, int64_t) {
+            ASSERT_EQ(shard, ticks.shard_for(tick.key));
+            ASSERT_EQ(tick.seq, next_seq[tick.key]++);
+            ++per_shard[shard];
+          });
+      if (processed < 0) {
+        EXPECT_EQ(processed, disruptor::kEof);
+        break;
+      }
+      consumed += processed;
+      if (processed == 0) std::this_thread::yield();
+    }
+  }};
+
+  for (auto& t : producers) t.join();
+  ticks.set_eof();
+  consumer.join();
+
+  EXPECT_EQ(consumed, kKeys * kPerKey);
+  for (auto n : per_shard) EXPECT_GT(n, 0);
+}
+
+/** a full shard does not starve the others */
+TEST(sharded_ring, fair_poll) {
+  disruptor::ShardedRing<Tick, disruptor::SingleProducerSequencer> ticks(3,
+                                                                        64);
+  for (int64_t seq = 0; seq < 40; ++seq) {
+    ticks.publish_event(0, translate, 0, seq);
+    ticks.publish_event(2, translate, 2, seq);
+  }
+  ticks.publish_event(1, translate, 1, 0);
+
+  std::vector<size_t> order;
+  auto record = [&](const Tick&, size_t shard, int64_t) {
+    order.push_back(shard);
+  };
+  EXPECT_EQ(ticks.poll(record, 10), 21);
+  EXPECT_EQ(order.size(), 21u);
+  EXPECT_EQ(order[0], 0u);
+  EXPECT_EQ(order[10], 1u);
+  EXPECT_EQ(order[11], 2u);
+
+  // the next round starts with shard 1
+  order.clear();
+  EXPECT_EQ(ticks.poll(record, 10), 20);
+  EXPECT_EQ(order.front(), 2u);
+  EXPECT_EQ(order.back(), 0u);
+
+  EXPECT_THROW(ticks.poll(record, 0), std::runtime_error);
+
+  ticks.halt();
+  EXPECT_EQ(ticks.poll(record, 10), disruptor::kHalted);
+}
+
+/** producers with a shard each, no claim is contended */
+TEST(sharded_ring, producer_affinity) {
+  static constexpr int kProducers = 3;
+  static constexpr int64_t kIterations = 10 * 1000;
+
+  disruptor::ShardedRing<Tick, disruptor::SingleProducerSequencer> ticks(
+      kProducers, 128);
+  std::vector<std::thread> producers;
+  std::vector<size_t> shards(kProducers);
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p] {
+      shards[p] = ticks.claim_shard();
+      for (int64_t seq = 0; seq < kIterations; ++seq)
+        ticks.publish_event(shards[p], translate, p, seq);
+    });
+  }
+
+  std::vector<int64_t> next_seq(kProducers, 0);
+  int64_t consumed = 0;
+  while (consumed < kProducers * kIterations) {
+    consumed += ticks.poll([&](const Tick& tick, size_t, int64_t) {
+      ASSERT_EQ(tick.seq, next_seq[tick.key]++);
+    });
+  }
+  for (auto& t : producers) t.join();
+  std::sort(shards.begin(), shards.end());
+  EXPECT_EQ(std::unique(shards.begin(), shards.end()), shards.end());
+
+  // every shard is owned until given back
+  EXPECT_THROW(ticks.claim_shard(), std::runtime_error);
+  ticks.release_shard(shards[1]);
+  EXPECT_EQ(ticks.claim_shard(), shards[1]);
+
+  // another ring hands out its own shards
+  disruptor::ShardedRing<Tick, disruptor::SingleProducerSequencer> other(
+      kProducers, 128);
+  EXPECT_EQ(other.claim_shard(), 0u);
+}
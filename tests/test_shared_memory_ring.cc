@@ -0,0 +1,175 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "slog.h"
+
+namespace {
+
+struct Quote {
+  int64_t pos;
+  int64_t price;
+};
+
+double now() {
+  struct timespec tp {};
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return (double)(tp.tv_sec) + (double)tp.tv_nsec / 1000 / 1000 / 1000;
+}
+
+/** consumes every event up to total as consumer index, checking that the
+ *  consumer before it has updated it first */
+template <typename WaitStrategy>
+bool consume(disruptor::SharedMemoryRing<Quote>& ring, int index,
+             int64_t total) {
+  auto consumer = ring.consumer<WaitStrategy>(index);
+  auto next_sequence = consumer->acquire() + 1;
+  while (next_sequence < total) {
+    auto available_sequence = consumer->wait_for(next_sequence);
+    for (; next_sequence <= available_sequence; ++next_sequence) {
+      auto& quote = ring.at(next_sequence);
+      if (quote.pos != next_sequence) return false;
+      if (quote.price != next_sequence * 2 + index - 1) return false;
+      // consumers later in the graph see the updates of earlier ones
+      ring.at(next_sequence).price += 1;
+    }
+    consumer->publish(available_sequence);
+  }
+  return true;
+}
+
+pid_t fork_consumer(const std::string& name, int index, int64_t total,
+                    bool blocking) {
+  auto pid = fork();
+  if (pid == 0) {
+    bool ok = false;
+    try {
+      auto ring = disruptor::SharedMemoryRing<Quote>::open(name);
+      ok = blocking
+               ? consume<disruptor::BlockingWaitStrategy>(*ring, index, total)
+               : consume<disruptor::YieldingWaitStrategy>(*ring, index, total);
+    } catch (...) {
+    }
+    // never return into the test runner of the parent
+    _exit(ok ? 0 : 1);
+  }
+  return pid;
+}
+
+}  // namespace
+
+TEST(shared_memory_ring, layout) {
+  auto ring = disruptor::SharedMemoryRing<Quote>::create_anonymous(
+      1 << 10, {{}, {0}});
+  EXPECT_EQ(ring->size(), 1 << 10);
+  EXPECT_EQ(ring->consumer_count(), 2);
+  EXPECT_EQ(ring->index(ring->size() + 3), 3);
+
+  // a second mapping at another address sees the same events and cursors
+  auto other = disruptor::SharedMemoryRing<Quote>::open(ring->fd());
+  EXPECT_NE(&ring->at(0), &other->at(0));
+  ring->at(5).price = 42;
+  EXPECT_EQ(other->at(ring->size() + 5).price, 42);
+  ring->producer()->publish(7);
+  EXPECT_EQ(other->producer_cursor()->acquire(), 7);
+  EXPECT_EQ(other->consumer_cursor(1)->acquire(), -1);
+
+  EXPECT_THROW(disruptor::SharedMemoryRing<int32_t>::open(ring->fd()),
+               std::runtime_error);
+  EXPECT_THROW(ring->consumer(2), std::out_of_range);
+}
+
+TEST(shared_memory_ring, invalid_topology) {
+  using Ring = disruptor::SharedMemoryRing<Quote>;
+  EXPECT_THROW(Ring::create_anonymous(1000, {{}}), std::runtime_error);
+  EXPECT_THROW(Ring::create_anonymous(1024, {}), std::logic_error);
+  EXPECT_THROW(Ring::create_anonymous(1024, {{}, {1}}), std::logic_error);
+  EXPECT_THROW(Ring::create_anonymous(1024, {{1}, {}}), std::logic_error);
+}
+
+/** the producer end claims like a SingleProducerSequencer */
+TEST(shared_memory_ring, producer_try_next) {
+  auto ring = disruptor::SharedMemoryRing<Quote>::create_anonymous(8, {{}});
+  auto producer = ring->producer();
+  auto consumer = ring->consumer(0);
+
+  EXPECT_EQ(producer->try_next(8), 7);
+  producer->publish(7);
+  EXPECT_EQ(producer->remaining_capacity(), 0);
+  EXPECT_EQ(producer->consumer_lag(), 8);
+  EXPECT_EQ(producer->try_next(), disruptor::kInsufficientCapacity);
+
+  EXPECT_EQ(consumer->wait_for(0), 7);
+  consumer->publish(3);
+  EXPECT_EQ(producer->try_next(4), 11);
+
+  consumer->halt();
+  EXPECT_EQ(producer->try_next(), disruptor::kHalted);
+  EXPECT_EQ(producer->next(), disruptor::kHalted);
+}
+
+/** a consumer the producer evicted for lagging is told so */
+TEST(shared_memory_ring, overrun) {
+  auto ring = disruptor::SharedMemoryRing<Quote>::create_anonymous(8, {{}});
+  auto producer = ring->producer(4);
+  auto consumer = ring->consumer(0);
+
+  producer->publish(producer->next(2));
+  EXPECT_EQ(consumer->try_wait_for(0), 1);
+  EXPECT_FALSE(consumer->overrun());
+
+  // a full lap and more, nothing waits for the consumer any more
+  for (int i = 0; i < 16; ++i) producer->publish(producer->next());
+  EXPECT_TRUE(consumer->overrun());
+  EXPECT_EQ(consumer->try_wait_for(0), disruptor::kOverrun);
+  EXPECT_EQ(consumer->wait_for(0), disruptor::kOverrun);
+  EXPECT_FALSE(consumer->eof());
+}
+
+TEST(shared_memory_ring, named_segment) {
+  auto name = "/disruptor_test_" + std::to_string(getpid());
+  auto ring = disruptor::SharedMemoryRing<Quote>::create(name, 64, {{}});
+  EXPECT_THROW(disruptor::SharedMemoryRing<Quote>::create(name, 64, {{}}),
+               std::system_error);
+  auto other = disruptor::SharedMemoryRing<Quote>::open(name);
+  EXPECT_EQ(other->size(), 64);
+  disruptor::SharedMemoryRing<Quote>::unlink(name);
+  EXPECT_THROW(disruptor::SharedMemoryRing<Quote>::open(name),
+               std::system_error);
+}
+
+/** a producer process and a -> b -> c consumer processes */
+TEST(shared_memory_ring, inter_process_pipeline) {
+  static constexpr int64_t kIterations = 1000 * 1000;
+  auto name = "/disruptor_test_" + std::to_string(getpid());
+  auto ring = disruptor::SharedMemoryRing<Quote>::create(name, 1 << 12,
+                                                         {{}, {0}, {1}});
+  std::vector<pid_t> children;
+  children.push_back(fork_consumer(name, 0, kIterations, false));
+  children.push_back(fork_consumer(name, 1, kIterations, true));
+  children.push_back(fork_consumer(name, 2, kIterations, false));
+
+  auto start = now();
+  auto producer = ring->producer();
+  for (int64_t i = 0; i < kIterations; ++i) {
+    auto pos = producer->next();
+    ring->at(pos) = {pos, pos * 2 - 1};
+    producer->publish(pos);
+  }
+
+  for (auto pid : children) {
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+  }
+  disruptor::SharedMemoryRing<Quote>::unlink(name);
+  LOGGER_DEBUG("1 producer - 3 consumer processes %f M ops/secs",
+               kIterations / (now() - start) / 1000.0 / 1000.0);
+  EXPECT_EQ(ring->consumer_cursor(2)->acquire(), kIterations - 1);
+}
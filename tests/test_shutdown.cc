@@ -0,0 +1,172 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "slog.h"
+
+namespace {
+
+struct CountingHandler {
+  int64_t* handled;
+  void on_event(const int64_t&, int64_t, bool) { ++*handled; }
+};
+
+template <typename Sequencer>
+void check_blocked_producer_halts() {
+  auto producer_sequence = std::make_shared<Sequencer>(8);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  ASSERT_EQ(producer_sequence->next(8), 7);
+
+  std::atomic<int64_t> pos{0};
+  std::thread producer{[&] { pos = producer_sequence->next(); }};
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  consumer_sequence->halt();
+  producer.join();
+
+  EXPECT_EQ(pos.load(), disruptor::kHalted);
+}
+
+}  // namespace
+
+/** set_eof() right after the last publish, nothing is lost downstream */
+TEST(shutdown, drain) {
+  static constexpr int64_t kSize = 64;
+  static constexpr int64_t kIterations = 10 * 1000;
+
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  auto first = std::make_shared<disruptor::ConsumerSequencer>();
+  auto second = std::make_shared<disruptor::ConsumerSequencer>();
+  first->follow(producer_sequence);
+  second->follow(first);
+  producer_sequence->follow(second);
+
+  auto consume = [&](std::shared_ptr<disruptor::ConsumerSequencer> consumer,
+                     int64_t* count) {
+    auto next_sequence = consumer->acquire() + 1;
+    while (true) {
+      auto available_sequence = consumer->wait_for(next_sequence);
+      if (available_sequence < next_sequence) {
+        EXPECT_EQ(available_sequence, disruptor::kEof);
+        break;
+      }
+      for (; next_sequence <= available_sequence; ++next_sequence) {
+        EXPECT_EQ(source_data->at(next_sequence), next_sequence);
+        ++*count;
+      }
+      consumer->publish(available_sequence);
+    }
+  };
+
+  int64_t first_count = 0;
+  int64_t second_count = 0;
+  std::thread first_thread{consume, first, &first_count};
+  std::thread second_thread{consume, second, &second_count};
+
+  for (int64_t i = 0; i < kIterations; ++i) {
+    auto pos = producer_sequence->next();
+    source_data->at(pos) = pos;
+    producer_sequence->publish(pos);
+  }
+  producer_sequence->set_eof();
+  first_thread.join();
+  second_thread.join();
+
+  EXPECT_EQ(first_count, kIterations);
+  EXPECT_EQ(second_count, kIterations);
+  EXPECT_TRUE(second->eof());
+  EXPECT_FALSE(second->halted());
+}
+
+/** halt() stops the consumers however many events they have left */
+TEST(shutdown, halt) {
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, 16>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(16);
+  auto first = std::make_shared<disruptor::ConsumerSequencer>();
+  auto second = std::make_shared<disruptor::ConsumerSequencer>();
+  first->follow(producer_sequence);
+  second->follow(first);
+  producer_sequence->follow(second);
+
+  producer_sequence->publish(producer_sequence->next(10));
+  producer_sequence->halt();
+  // a set_eof() afterwards does not turn the halt into a drain
+  producer_sequence->set_eof();
+  EXPECT_TRUE(producer_sequence->halted());
+
+  EXPECT_EQ(first->wait_for(0), disruptor::kHalted);
+  EXPECT_TRUE(first->halted());
+  EXPECT_EQ(second->wait_for(0), disruptor::kHalted);
+
+  int64_t handled = 0;
+  auto processor = disruptor::make_batch_event_processor(
+      source_data, std::make_shared<disruptor::ConsumerSequencer>(),
+      CountingHandler{&handled});
+  processor.consumer()->follow(producer_sequence);
+  EXPECT_EQ(processor.process_batch(), disruptor::kHalted);
+  processor.run();
+  EXPECT_EQ(handled, 0);
+}
+
+TEST(shutdown, single_producer_blocked_in_next) {
+  check_blocked_producer_halts<disruptor::SingleProducerSequencer>();
+}
+
+TEST(shutdown, multi_producer_blocked_in_next) {
+  check_blocked_producer_halts<disruptor::MultiProducerSequencer>();
+}
+
+TEST(shutdown, multi_producer_after_eof) {
+  auto producer_sequence =
+      std::make_shared<disruptor::MultiProducerSequencer>(8);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  auto pos = producer_sequence->next();
+  producer_sequence->set_eof();
+  EXPECT_FALSE(producer_sequence->publish_after(pos, pos - 1));
+  EXPECT_EQ(producer_sequence->next(), disruptor::kEof);
+  EXPECT_EQ(producer_sequence->try_next(), disruptor::kEof);
+  EXPECT_EQ(consumer_sequence->wait_for(0), disruptor::kEof);
+
+  producer_sequence->halt();
+  EXPECT_EQ(producer_sequence->next(), disruptor::kHalted);
+}
+
+TEST(shutdown, worker_pool_drain) {
+  static constexpr int64_t kIterations = 1000;
+
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, 64>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(
+          source_data->size());
+  auto pool = std::make_shared<disruptor::WorkerPool>(source_data->size(), 4);
+  producer_sequence->follow(pool);
+  pool->follow(producer_sequence);
+
+  std::atomic<int64_t> processed{0};
+  std::thread worker{[&] {
+    while (pool->work([&](int64_t) { processed.fetch_add(1); })) {
+    }
+  }};
+
+  for (int64_t i = 0; i < kIterations; ++i) {
+    auto pos = producer_sequence->next();
+    source_data->at(pos) = pos;
+    producer_sequence->publish(pos);
+  }
+  producer_sequence->set_eof();
+  worker.join();
+
+  EXPECT_EQ(processed.load(), kIterations);
+  EXPECT_TRUE(pool->eof());
+}
@@ -0,0 +1,136 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "slog.h"
+
+namespace {
+
+struct Quote {
+  int64_t pos;
+  int64_t bid;
+  int64_t ask;
+};
+
+}  // namespace
+
+/** a consumer past its lag limit is evicted, the producer never blocks */
+TEST(slow_consumers, evict) {
+  static constexpr int64_t kSize = 64;
+  static constexpr int64_t kIterations = 10 * 1000;
+
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  auto stuck_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence);
+  producer_sequence->follow(stuck_sequence, kSize / 4);
+  consumer_sequence->follow(producer_sequence);
+  stuck_sequence->follow(producer_sequence);
+
+  std::thread consumer{[&] {
+    auto next_sequence = consumer_sequence->acquire() + 1;
+    while (next_sequence < kIterations) {
+      auto available_sequence = consumer_sequence->wait_for(next_sequence);
+      ASSERT_GE(available_sequence, next_sequence);
+      next_sequence = available_sequence + 1;
+      consumer_sequence->publish(available_sequence);
+    }
+  }};
+  for (int64_t i = 0; i < kIterations; ++i)
+    producer_sequence->publish(producer_sequence->next());
+  consumer.join();
+
+  EXPECT_TRUE(stuck_sequence->overrun());
+  EXPECT_FALSE(consumer_sequence->overrun());
+  EXPECT_EQ(stuck_sequence->wait_for(0), disruptor::kOverrun);
+  EXPECT_EQ(stuck_sequence->try_wait_for(0), disruptor::kOverrun);
+  EXPECT_FALSE(producer_sequence->unfollow(*stuck_sequence));
+
+  // joins again where the stream is now
+  auto skipped = stuck_sequence->join();
+  producer_sequence->follow(stuck_sequence, kSize / 4);
+  EXPECT_EQ(skipped, kIterations - 1);
+  EXPECT_FALSE(stuck_sequence->overrun());
+  producer_sequence->publish(producer_sequence->next());
+  EXPECT_EQ(stuck_sequence->wait_for(kIterations), kIterations);
+}
+
+/** consumers within their lag limit hold the producer back as usual */
+TEST(slow_consumers, within_limit) {
+  static constexpr int64_t kSize = 64;
+
+  auto producer_sequence =
+      std::make_shared<disruptor::MultiProducerSequencer>(kSize);
+  auto consumer_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+  producer_sequence->follow(consumer_sequence, kSize / 2);
+  consumer_sequence->follow(producer_sequence);
+
+  auto pos = producer_sequence->next(kSize / 2);
+  producer_sequence->publish_after(pos, pos - kSize / 2);
+  EXPECT_EQ(consumer_sequence->wait_for(0), pos);
+  consumer_sequence->publish(pos);
+
+  pos = producer_sequence->next(kSize / 2);
+  EXPECT_FALSE(consumer_sequence->overrun());
+  producer_sequence->publish_after(pos, pos - kSize / 2);
+
+  // one more than the consumer may lag behind
+  pos = producer_sequence->try_next();
+  EXPECT_EQ(pos, kSize);
+  EXPECT_TRUE(consumer_sequence->overrun());
+  EXPECT_EQ(consumer_sequence->wait_for(kSize / 2), disruptor::kOverrun);
+}
+
+/** readers of a lossy ring detect the events overwritten under them */
+TEST(slow_consumers, broadcast) {
+  static constexpr int64_t kSize = 16;
+  static constexpr int64_t kIterations = 200 * 1000;
+
+  auto ring = std::make_shared<disruptor::BroadcastRingBuffer<Quote, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+
+  auto read = [&](int64_t* received, int64_t* lost) {
+    auto reader_sequence = std::make_shared<disruptor::ConsumerSequencer>();
+    reader_sequence->follow(producer_sequence);
+    int64_t next_sequence = 0;
+    while (next_sequence < kIterations) {
+      auto available_sequence = reader_sequence->wait_for(next_sequence);
+      for (; next_sequence <= available_sequence; ++next_sequence) {
+        Quote quote;
+        if (!ring->read(next_sequence, quote)) {
+          auto oldest = ring->oldest(producer_sequence->acquire());
+          *lost += oldest - next_sequence;
+          next_sequence = oldest - 1;
+          continue;
+        }
+        ASSERT_EQ(quote.pos, next_sequence);
+        ASSERT_EQ(quote.ask - quote.bid, 1);
+        ++*received;
+      }
+    }
+  };
+
+  int64_t received = 0;
+  int64_t lost = 0;
+  std::thread reader{read, &received, &lost};
+  for (int64_t i = 0; i < kIterations; ++i) {
+    auto pos = producer_sequence->next();
+    ring->write(pos, Quote{pos, pos * 2, pos * 2 + 1});
+    producer_sequence->publish(pos);
+  }
+  reader.join();
+
+  EXPECT_EQ(received + lost, kIterations);
+  LOGGER_DEBUG("reader received %ld, lost %ld", received, lost);
+
+  // a reader that starts late loses everything overwritten
+  int64_t late_received = 0;
+  int64_t late_lost = 0;
+  read(&late_received, &late_lost);
+  EXPECT_EQ(late_received, kSize);
+  EXPECT_EQ(late_lost, kIterations - kSize);
+}
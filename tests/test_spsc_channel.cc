@@ -0,0 +1,70 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "slog.h"
+
+TEST(spsc_channel, transfer) {
+  static constexpr int64_t kIterations = 1000 * 1000;
+
+  auto channel = std::make_shared<disruptor::SpscChannel<
+      int64_t, 1024, disruptor::YieldingWaitStrategy>>();
+
+  std::thread producer{[&] {
+    for (int64_t i = 0; i < kIterations; i += 4) {
+      auto end = channel->next(4);
+      for (auto pos = end - 3; pos <= end; ++pos) channel->at(pos) = pos;
+      channel->publish(end);
+    }
+    channel->set_eof();
+  }};
+
+  int64_t consumed = 0;
+  int64_t next_sequence = 0;
+  while (true) {
+    auto available_sequence = channel->wait_for(next_sequence);
+    if (available_sequence < next_sequence) {
+      EXPECT_EQ(available_sequence, disruptor::kEof);
+      break;
+    }
+    for (; next_sequence <= available_sequence; ++next_sequence) {
+      ASSERT_EQ(channel->at(next_sequence), next_sequence);
+      ++consumed;
+    }
+    channel->release(available_sequence);
+  }
+  producer.join();
+  EXPECT_EQ(consumed, kIterations);
+}
+
+TEST(spsc_channel, capacity) {
+  disruptor::SpscChannel<int64_t, 8> channel;
+
+  EXPECT_EQ(channel.try_wait_for(0), -1);
+  EXPECT_EQ(channel.try_next(8), 7);
+  EXPECT_EQ(channel.try_next(), disruptor::kInsufficientCapacity);
+  channel.publish(7);
+
+  EXPECT_EQ(channel.try_wait_for(0), 7);
+  channel.release(1);
+  EXPECT_EQ(channel.try_next(2), 9);
+  EXPECT_EQ(channel.try_next(), disruptor::kInsufficientCapacity);
+}
+
+TEST(spsc_channel, halt) {
+  disruptor::SpscChannel<int64_t, 8> channel;
+  channel.publish(channel.next(8));
+
+  std::atomic<int64_t> pos{0};
+  std::thread producer{[&] { pos = channel.next(); }};
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  channel.halt();
+  producer.join();
+
+  EXPECT_EQ(pos.load(), disruptor::kHalted);
+  // nothing is consumed past a halt, however much was published
+  EXPECT_EQ(channel.wait_for(0), disruptor::kHalted);
+}
@@ -0,0 +1,95 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <thread>
+#include <vector>
+
+TEST(topology, diamond) {
+  static constexpr int64_t kSize = 1024;
+  static constexpr int64_t kIterations = 1000 * 1000;
+
+  struct Event {
+    int64_t value;
+    int64_t enriched;
+    int64_t journaled;
+  };
+
+  auto ring = std::make_shared<disruptor::RingBuffer<Event, kSize>>();
+  auto producer = std::make_shared<disruptor::SingleProducerSequencer>(kSize);
+  auto decode = std::make_shared<disruptor::ConsumerSequencer>();
+  auto enrich = std::make_shared<disruptor::ConsumerSequencer>();
+  auto journal = std::make_shared<
+      disruptor::BasicConsumerSequencer<disruptor::YieldingWaitStrategy>>();
+  auto publish = std::make_shared<disruptor::ConsumerSequencer>();
+
+  // decode -> (enrich || journal) -> publish
+  disruptor::Topology topology(producer);
+  topology.then(decode).and_then_parallel(enrich, journal).join(publish);
+  topology.build();
+  ASSERT_EQ(topology.gating_sequences().size(), 1);
+  EXPECT_EQ(topology.gating_sequences()[0], publish);
+
+  auto stage = [&](std::shared_ptr<disruptor::EventCursor> cursor,
+                   std::function<void(Event&, int64_t)> handler,
+                   std::function<int64_t(int64_t)> wait_for) {
+    return std::thread{[=] {
+      auto next_sequence = cursor->acquire() + 1;
+      while (next_sequence < kIterations) {
+        auto available_sequence = wait_for(next_sequence);
+        for (; next_sequence <= available_sequence; ++next_sequence) {
+          handler(ring->at(next_sequence), next_sequence);
+        }
+        cursor->publish(available_sequence);
+      }
+    }};
+  };
+
+  std::vector<std::thread> threads;
+  threads.push_back(stage(
+      decode, [](Event& e, int64_t pos) { ASSERT_EQ(e.value, pos); },
+      [=](int64_t pos) { return decode->wait_for(pos); }));
+  threads.push_back(stage(
+      enrich, [](Event& e, int64_t) { e.enriched = e.value * 2; },
+      [=](int64_t pos) { return enrich->wait_for(pos); }));
+  threads.push_back(stage(
+      journal, [](Event& e, int64_t) { e.journaled = e.value + 1; },
+      [=](int64_t pos) { return journal->wait_for(pos); }));
+  threads.push_back(stage(
+      publish,
+      [](Event& e, int64_t pos) {
+        ASSERT_EQ(e.enriched, pos * 2);
+        ASSERT_EQ(e.journaled, pos + 1);
+      },
+      [=](int64_t pos) { return publish->wait_for(pos); }));
+
+  for (int64_t i = 0; i < kIterations; ++i) {
+    auto pos = producer->next();
+    ring->at(pos) = Event{pos, 0, 0};
+    producer->publish(pos);
+  }
+  for (auto& t : threads) t.join();
+}
+
+TEST(topology, rejects_invalid_graphs) {
+  auto producer = std::make_shared<disruptor::SingleProducerSequencer>(16);
+  auto a = std::make_shared<disruptor::ConsumerSequencer>();
+  auto b = std::make_shared<disruptor::ConsumerSequencer>();
+  auto c = std::make_shared<disruptor::ConsumerSequencer>();
+
+  disruptor::Topology cycle(producer);
+  cycle.add(a, {c}).add(b, {a}).add(c, {b});
+  EXPECT_THROW(cycle.build(), std::logic_error);
+
+  disruptor::Topology twice(producer);
+  twice.then(a);
+  EXPECT_THROW(twice.then(a), std::logic_error);
+
+  disruptor::Topology unknown(producer);
+  unknown.add(a, {b});
+  EXPECT_THROW(unknown.build(), std::logic_error);
+
+  disruptor::Topology parallel(producer);
+  parallel.and_then_parallel(std::vector<decltype(a)>{a, b, c}).build();
+  EXPECT_EQ(parallel.gating_sequences().size(), 3);
+}
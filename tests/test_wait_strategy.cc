@@ -0,0 +1,172 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "slog.h"
+
+namespace {
+
+int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ *  Bursty 1 producer - 1 consumer run: the producer publishes kBurst
+ *  timestamped events and then pauses, the consumer records how long every
+ *  event sat in the ring before it was seen.
+ */
+template <typename WaitStrategy>
+void wait_strategy_latency(const char* name) {
+  static constexpr int64_t kSize = 1024;
+  static constexpr int64_t kBurst = 16;
+  static constexpr int64_t kIterations = 200 * kBurst;
+
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(
+          source_data->size());
+  auto consumer_sequence =
+      std::make_shared<disruptor::BasicConsumerSequencer<WaitStrategy>>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  std::thread producer{[=] {
+    for (int64_t i = 0; i < kIterations; ++i) {
+      auto pos = producer_sequence->next();
+      source_data->at(pos) = now_ns();
+      producer_sequence->publish(pos);
+      if (i % kBurst == kBurst - 1) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+    }
+    producer_sequence->set_eof();
+  }};
+
+  std::vector<int64_t> latencies;
+  latencies.reserve(kIterations);
+  auto next_sequence = consumer_sequence->acquire() + 1;
+  while (true) {
+    auto available_sequence = consumer_sequence->wait_for(next_sequence);
+    if (available_sequence < next_sequence) break;
+    auto now = now_ns();
+    while (next_sequence <= available_sequence) {
+      latencies.push_back(now - source_data->at(next_sequence));
+      ++next_sequence;
+    }
+    consumer_sequence->publish(available_sequence);
+  }
+  producer.join();
+
+  ASSERT_FALSE(latencies.empty());
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) {
+    return latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+  };
+  LOGGER_DEBUG("%s latency: p50 %ld ns, p99 %ld ns, p99.9 %ld ns, max %ld ns",
+               name, percentile(0.5), percentile(0.99), percentile(0.999),
+               latencies.back());
+}
+
+}  // namespace
+
+TEST(wait_strategy, busy_spin_latency) {
+  wait_strategy_latency<disruptor::BusySpinWaitStrategy>("busy spin");
+}
+
+TEST(wait_strategy, yielding_latency) {
+  wait_strategy_latency<disruptor::YieldingWaitStrategy>("yielding");
+}
+
+TEST(wait_strategy, sleeping_latency) {
+  wait_strategy_latency<disruptor::SleepingWaitStrategy>("sleeping");
+}
+
+TEST(wait_strategy, blocking_latency) {
+  wait_strategy_latency<disruptor::BlockingWaitStrategy>("blocking");
+}
+
+TEST(wait_strategy, blocking_wakes_on_eof) {
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(16);
+  auto consumer_sequence = std::make_shared<
+      disruptor::BasicConsumerSequencer<disruptor::BlockingWaitStrategy>>(0);
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  std::thread producer{[=] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    producer_sequence->set_eof();
+  }};
+  EXPECT_EQ(consumer_sequence->wait_for(0), disruptor::kEof);
+  EXPECT_TRUE(consumer_sequence->eof());
+  producer.join();
+}
+
+TEST(wait_strategy, blocking_idle_cpu_and_wakeup) {
+  static constexpr int64_t kIterations = 100;
+
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, 16>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(
+          source_data->size());
+  auto consumer_sequence = std::make_shared<
+      disruptor::BasicConsumerSequencer<disruptor::BlockingWaitStrategy>>();
+  producer_sequence->follow(consumer_sequence);
+  consumer_sequence->follow(producer_sequence);
+
+  int64_t wakeup_ns = 0;
+  struct rusage usage {};
+  std::thread consumer{[&] {
+    auto next_sequence = consumer_sequence->acquire() + 1;
+    while (true) {
+      auto available_sequence = consumer_sequence->wait_for(next_sequence);
+      if (available_sequence < next_sequence) break;
+      wakeup_ns += now_ns() - source_data->at(available_sequence);
+      next_sequence = available_sequence + 1;
+      consumer_sequence->publish(available_sequence);
+    }
+    getrusage(RUSAGE_THREAD, &usage);
+  }};
+
+  // the consumer spends nearly all of this time asleep in the futex
+  for (int64_t i = 0; i < kIterations; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    auto pos = producer_sequence->next();
+    source_data->at(pos) = now_ns();
+    producer_sequence->publish(pos);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  producer_sequence->set_eof();
+  consumer.join();
+
+  auto cpu_us = usage.ru_utime.tv_sec * 1000 * 1000 + usage.ru_utime.tv_usec +
+                usage.ru_stime.tv_sec * 1000 * 1000 + usage.ru_stime.tv_usec;
+  LOGGER_DEBUG("blocking wakeup: avg %ld ns, consumer cpu %ld us over %ld ms",
+               wakeup_ns / kIterations, cpu_us, kIterations);
+}
+
+TEST(wait_strategy, publish_cost_without_waiters) {
+  static constexpr int64_t kIterations = 10 * 1000 * 1000;
+
+  disruptor::EventCursor polled;
+  disruptor::EventCursor blocking;
+  blocking.enable_notify();
+
+  auto publish_ns = [](disruptor::EventCursor& cursor) {
+    auto start = now_ns();
+    for (int64_t i = 0; i < kIterations; ++i) cursor.publish(i);
+    return (double)(now_ns() - start) / kIterations;
+  };
+
+  auto polled_ns = publish_ns(polled);
+  auto blocking_ns = publish_ns(blocking);
+  LOGGER_DEBUG("publish: %f ns polled, %f ns with notify and no waiters",
+               polled_ns, blocking_ns);
+}
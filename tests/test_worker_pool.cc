@@ -0,0 +1,102 @@
+#include <disruptor/disruptor.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "slog.h"
+
+static constexpr auto kWorkerThreadNum = 3;
+
+TEST(worker_pool, each_event_processed_once) {
+  static constexpr int64_t kSize = 256;
+  static constexpr int64_t kIterations = 200 * 1000;
+
+  auto source_data = std::make_shared<disruptor::RingBuffer<int64_t, kSize>>();
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(
+          source_data->size());
+  auto pool = std::make_shared<disruptor::WorkerPool>(source_data->size(), 8);
+  producer_sequence->follow(pool);
+  pool->follow(producer_sequence);
+
+  std::vector<std::atomic<int>> processed(kIterations);
+  std::atomic<int64_t> processed_count{0};
+  std::array<int64_t, kWorkerThreadNum> per_worker{};
+
+  std::array<std::thread, kWorkerThreadNum> workers;
+  for (auto i = 0; i < kWorkerThreadNum; i++) {
+    workers[i] = std::thread{[&, i] {
+      while (pool->work([&](int64_t pos) {
+        ASSERT_EQ(source_data->at(pos), pos);
+        // skewed cost: some events are far more expensive
+        if (pos % 97 == 0) std::this_thread::yield();
+        processed[pos].fetch_add(1);
+        ++per_worker[i];
+        processed_count.fetch_add(1);
+      })) {
+      }
+    }};
+  }
+
+  for (int64_t i = 0; i < kIterations; ++i) {
+    auto pos = producer_sequence->next();
+    source_data->at(pos) = pos;
+    producer_sequence->publish(pos);
+  }
+  while (processed_count.load() < kIterations) std::this_thread::yield();
+  producer_sequence->set_eof();
+  for (auto& w : workers) w.join();
+
+  for (int64_t pos = 0; pos < kIterations; ++pos) {
+    ASSERT_EQ(processed[pos].load(), 1) << "at " << pos;
+  }
+  EXPECT_TRUE(pool->eof());
+  LOGGER_DEBUG("%d workers processed %ld, %ld, %ld events", kWorkerThreadNum,
+               per_worker[0], per_worker[1], per_worker[2]);
+}
+
+TEST(worker_pool, gates_producer_on_processed_events) {
+  auto producer_sequence =
+      std::make_shared<disruptor::SingleProducerSequencer>(8);
+  auto pool = std::make_shared<disruptor::WorkerPool>(8, 2);
+  producer_sequence->follow(pool);
+  pool->follow(producer_sequence);
+
+  auto end = producer_sequence->next(8);
+  producer_sequence->publish(end);
+
+  auto first = pool->claim(2);
+  auto second = pool->claim(2);
+  pool->complete(second - 1, second);
+
+  // the first claim is still being processed
+  auto pool_barrier = std::make_shared<disruptor::ConsumerSequencer>();
+  pool_barrier->follow(pool);
+  pool->complete(first - 1, first);
+  EXPECT_EQ(pool_barrier->wait_for(0), second);
+}
+
+/** workers wait out of order, a later claim published first must not make
+ *  the earlier, unpublished one available */
+TEST(worker_pool, out_of_order_multi_producer_publish) {
+  auto producer_sequence =
+      std::make_shared<disruptor::MultiProducerSequencer>(8);
+  auto pool = std::make_shared<disruptor::WorkerPool>(8, 2);
+  producer_sequence->follow(pool);
+  pool->follow(producer_sequence);
+
+  auto a = producer_sequence->next(2);
+  auto b = producer_sequence->next(2);
+  producer_sequence->publish_after(b, b - 2);
+
+  auto first = pool->claim(2);
+  auto second = pool->claim(2);
+  EXPECT_EQ(pool->wait_for(second - 1), 3);
+  EXPECT_LT(pool->try_wait_for(first - 1), first - 1);
+
+  producer_sequence->publish_after(a, a - 2);
+  EXPECT_EQ(pool->try_wait_for(first - 1), 3);
+}